@@ -0,0 +1,133 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdint.h>
+
+
+/* *
+ * FrameRateTuner - Picks the frame interval for an effect from the measured cost of its frames.
+ *
+ * Each frame's cost is its render time plus its show time. The tuner keeps a smoothed cost and a
+ * smoothed deviation from it, the way TCP estimates round trip time, and plans for the cost plus
+ * twice the deviation so occasional slow frames don't overrun. The interval is the shortest one
+ * in the effect's bounds where that cost uses no more than the CPU budget, leaving the rest of
+ * the time for reading and handling input.
+ *
+ * A rising cost lengthens the interval on the next frame. A falling cost only shortens it once
+ * the shorter interval has held for a number of frames, so the rate doesn't hunt.
+ * */
+class FrameRateTuner
+{
+
+private:
+    static const uint8_t Shift = 3;             // Smoothing, each sample moves the averages by 1/8
+    static const uint8_t SettleFrames = 16;     // Frames a shorter interval must hold before it's used
+
+    uint16_t m_minMs;                           // Shortest interval allowed
+    uint16_t m_maxMs;                           // Longest interval allowed
+    uint8_t m_budgetPct;                        // Share of each interval frames may use
+    uint16_t m_intervalMs;                      // Chosen interval
+    uint32_t m_costUs;                          // Smoothed cost << Shift, 0 before the first sample
+    uint32_t m_devUs;                           // Smoothed deviation << Shift
+    uint8_t m_settle;                           // Frames a shorter interval has held
+
+public:
+
+    explicit FrameRateTuner(uint8_t budgetPct) :
+        m_minMs(1000),
+        m_maxMs(1000),
+        m_budgetPct(budgetPct),
+        m_intervalMs(1000),
+        m_costUs(0),
+        m_devUs(0),
+        m_settle(0)
+    {
+
+    }
+
+    /**
+     * @brief reset - Starts tuning from the shortest interval, forgetting the measured cost. Used
+     * when the effect or the amount of work each frame does changes.
+     * @param minMs - Shortest interval allowed
+     * @param maxMs - Longest interval allowed
+     */
+    void reset(uint16_t minMs, uint16_t maxMs)
+    {
+        m_minMs = minMs;
+        m_maxMs = maxMs < minMs ? minMs : maxMs;
+        m_intervalMs = minMs;
+        m_costUs = 0;
+        m_devUs = 0;
+        m_settle = 0;
+    }
+
+    /**
+     * @brief sample - Adds the cost of a frame and retunes the interval
+     * @param renderUs - Time the frame took to render
+     * @param showUs - Time the frame took to show
+     */
+    void sample(uint32_t renderUs, uint32_t showUs)
+    {
+        uint32_t cost = renderUs + showUs;
+
+        if(m_costUs == 0) {
+            m_costUs = cost << Shift;
+            m_devUs = (cost / 4) << Shift;
+        } else {
+            uint32_t avg = m_costUs >> Shift;
+            uint32_t dev = cost > avg ? cost - avg : avg - cost;
+            m_costUs = m_costUs - avg + cost;
+            m_devUs = m_devUs - (m_devUs >> Shift) + dev;
+        }
+
+        uint32_t planUs = costUs() + 2 * (m_devUs >> Shift);
+        uint32_t target = (planUs * 100 / m_budgetPct + 999) / 1000;
+
+        if(target < m_minMs) target = m_minMs;
+        if(target > m_maxMs) target = m_maxMs;
+
+        if(target >= m_intervalMs) {
+            m_intervalMs = target;
+            m_settle = 0;
+        } else if(++m_settle >= SettleFrames) {
+            m_intervalMs = target;
+            m_settle = 0;
+        }
+    }
+
+    uint16_t intervalMs() const
+    {
+        return m_intervalMs;
+    }
+
+    /**
+     * @brief costUs - Get the smoothed cost of a frame
+     * @return
+     */
+    uint32_t costUs() const
+    {
+        return m_costUs >> Shift;
+    }
+
+};
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,138 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef BLUR_H
+#define BLUR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* *
+ * 1D advection kernels over arrays of 8bit cells, in place.
+ *
+ * Every kernel takes a stride, the number of interleaved channels: 1 for a byte array such as a
+ * fire's heat, 3 for a CRGB array cast to bytes. Each channel is filtered on its own.
+ *
+ * The kernels keep the neighbours they still need in a rolling window of registers, so each cell
+ * is read once and written once and no copy of the array is needed. Weighted sums are normalized
+ * by multiplying by a 16bit reciprocal of the total and shifting, which is an exact shift for a
+ * power of 2 total and exact integer division for any total up to BLUR_MAX_TOTAL, so results match
+ * the per cell loops with their divisions exactly.
+ *      kernel_advect8_down - Each cell becomes a weighted sum of itself and the cells above it, moving
+ *                            content towards 0
+ * */
+
+#define BLUR_MAX_TAPS       4           // Most weights an advection takes
+#define BLUR_MAX_TOTAL      16          // Largest weight total divided exactly, or any power of 2 up to 256
+
+
+/**
+ * @brief kernel_reciprocal - 16bit fixed point reciprocal for kernel_normalize()
+ * @param total - Sum of the weights
+ * @return
+ */
+inline uint32_t kernel_reciprocal(uint16_t total) {
+    return (65536 + total - 1) / total;
+}
+
+/**
+ * @brief kernel_normalize - Divides a weighted sum by its total
+ * @param sum
+ * @param reciprocal - From kernel_reciprocal()
+ * @return
+ */
+inline uint8_t kernel_normalize(uint32_t sum, uint32_t reciprocal) {
+    return (sum * reciprocal) >> 16;
+}
+
+/**
+ * @brief kernel_advect8_down - Sets each cell i to (weights[0] * cell i + weights[1] * cell i + 1
+ * + ...) / total going up from 0, so each cell is made from cells not yet written and content
+ * moves towards 0
+ * @tparam Taps - Number of weights, 1 to BLUR_MAX_TAPS
+ * @param data - Cells as bytes
+ * @param count - Number of cells
+ * @param stride - Channels per cell
+ * @param weights - Weight of the cell itself and of each cell above it
+ * @param total - Sum of the weights, a power of 2 or at most BLUR_MAX_TOTAL
+ * @param wrap - Cells past the end wrap round to the start, already written, the way a loop
+ * indexing (i + j) % count does. Otherwise the last Taps - 1 cells are left as they are.
+ */
+template<uint8_t Taps>
+inline void kernel_advect8_down(uint8_t* data, size_t count, size_t stride,
+                                const uint8_t* weights, uint16_t total, bool wrap) {
+
+    static_assert(Taps >= 1 && Taps <= BLUR_MAX_TAPS, "Taps must be 1 to BLUR_MAX_TAPS");
+
+    const uint32_t reciprocal = kernel_reciprocal(total);
+
+    if(count < Taps) {
+        // Too few cells for the window to only hold cells once they're final
+        if(!wrap) return;
+        for(size_t c = 0; c < stride; c++) {
+            for(size_t i = 0; i < count; i++) {
+                uint32_t sum = 0;
+                for(size_t j = 0; j < Taps; j++) sum += weights[j] * data[((i + j) % count) * stride + c];
+                data[i * stride + c] = kernel_normalize(sum, reciprocal);
+            }
+        }
+        return;
+    }
+
+    // Copied out, weights could alias data
+    const uint32_t w0 = weights[0];
+    const uint32_t w1 = Taps > 1 ? weights[1] : 0;
+    const uint32_t w2 = Taps > 2 ? weights[2] : 0;
+    const uint32_t w3 = Taps > 3 ? weights[3] : 0;
+
+    const size_t inside = count - (Taps - 1);        // Cells whose window doesn't wrap
+
+    for(size_t c = 0; c < stride; c++) {
+
+        uint8_t* p = data + c;
+        uint8_t* in = p + (Taps - 1) * stride;      // Cell entering the window
+        uint32_t c0 = p[0];
+        uint32_t c1 = Taps > 2 ? p[stride] : 0;
+        uint32_t c2 = Taps > 3 ? p[2 * stride] : 0;
+
+        for(size_t i = 0; i < count; i++, p += stride, in += stride) {
+
+            if(i == inside) {
+                if(!wrap) break;
+                in = data + c;
+            }
+
+            uint32_t e = *in;
+            uint32_t sum;
+            if(Taps == 1)      sum = w0 * e;
+            else if(Taps == 2) sum = w0 * c0 + w1 * e;
+            else if(Taps == 3) sum = w0 * c0 + w1 * c1 + w2 * e;
+            else               sum = w0 * c0 + w1 * c1 + w2 * c2 + w3 * e;
+
+            *p = kernel_normalize(sum, reciprocal);
+
+            if(Taps == 2)      c0 = e;
+            else if(Taps == 3) { c0 = c1; c1 = e; }
+            else if(Taps == 4) { c0 = c1; c1 = c2; c2 = e; }
+        }
+    }
+}
+
+#endif // BLUR_H
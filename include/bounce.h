@@ -23,6 +23,7 @@ using namespace std;
 #include <vector>
 
 #include "ledgfx.h"
+#include "kernels.h"
 
 static const CRGB ballColors [] =
 {
@@ -52,9 +53,67 @@ class BouncingBallEffect
     const double ImpactVelocity = InitialBallSpeed(StartHeight);
     const double SpeedKnob = 4.0;                   // Higher values will slow the effect
 
-    vector<double> ClockTimeAtLastBounce, Height, BallSpeed, Dampening;
+    const float  StepSeconds = 0.005f;              // Wall clock time covered by one physics step
+    const int    MaxStepsPerFrame = 16;             // Bound on catch-up steps after a stalled frame
+    const float  BallSize = 2.0f;                   // Drawn width of a ball in pixels
+
+    double  _lastClock;                             // Clock time of the last Advance()
+    float   _accumulator;                           // Wall clock time not yet simulated
+
+    vector<float>  Height, PrevHeight, Velocity, LaunchSpeed, Dampening;
     vector<CRGB>   Colors;
 
+    // Step
+    //
+    // Advance every ball by one fixed physics step using semi-implicit Euler integration.  Bounces
+    // are detected here rather than in Draw() so they no longer depend on when a frame happens to land.
+
+    void Step()
+    {
+        const float dt = StepSeconds / SpeedKnob;
+
+        for (size_t i = 0; i < _cBalls; i++)
+        {
+            PrevHeight[i] = Height[i];
+            Velocity[i]  += Gravity * dt;
+            Height[i]    += Velocity[i] * dt;
+
+            // Ball hits ground - bounce!
+            if (Height[i] < 0)
+            {
+                Height[i] = 0;
+                LaunchSpeed[i] = Dampening[i] * LaunchSpeed[i];
+
+                if (LaunchSpeed[i] < 0.01f)
+                    LaunchSpeed[i] = InitialBallSpeed(StartHeight) * Dampening[i];
+
+                Velocity[i] = LaunchSpeed[i];
+            }
+        }
+    }
+
+    // Advance
+    //
+    // Run as many fixed steps as the wall clock has moved since the last call.  If we fall too far
+    // behind (a long stall) the backlog is dropped rather than spending a whole frame catching up.
+
+    void Advance(double now)
+    {
+        _accumulator += (float)(now - _lastClock);
+        _lastClock = now;
+
+        int steps = 0;
+        while (_accumulator >= StepSeconds && steps < MaxStepsPerFrame)
+        {
+            Step();
+            _accumulator -= StepSeconds;
+            steps++;
+        }
+
+        if (_accumulator >= StepSeconds)
+            _accumulator = 0;
+    }
+
   public:
 
     // BouncingBallEffect
@@ -67,68 +126,123 @@ class BouncingBallEffect
           _cBalls(ballCount),
           _fadeRate(fade),
           _bMirrored(bMirrored),
-          ClockTimeAtLastBounce(ballCount),
+          _lastClock(UnixTime()),
+          _accumulator(0),
           Height(ballCount),
-          BallSpeed(ballCount),
+          PrevHeight(ballCount),
+          Velocity(ballCount),
+          LaunchSpeed(ballCount),
           Dampening(ballCount),
           Colors(ballCount)
     {
         for (size_t i = 0; i < ballCount; i++)
         {
-            Height[i]                = StartHeight;                 // Current Ball Height
-            ClockTimeAtLastBounce[i] = UnixTime();                  // When ball last hit ground state
+            Height[i]                = 0;                           // Balls are launched from the ground
+            PrevHeight[i]            = 0;                           // Height at the previous physics step
             Dampening[i]             = 0.90 - i / pow(_cBalls, 2);  // Bounciness of this ball
-            BallSpeed[i]             = InitialBallSpeed(Height[i]); // Don't dampen initial launch
+            LaunchSpeed[i]           = InitialBallSpeed(StartHeight); // Don't dampen initial launch
+            Velocity[i]              = LaunchSpeed[i];              // Current vertical speed
             Colors[i]                = ballColors[i % ARRAYSIZE(ballColors) ];
         }
     }
 
+    // StateSize
+    //
+    // Number of bytes SaveState() needs; height, velocity and launch speed of each ball
+
+    size_t StateSize() const
+    {
+        return _cBalls * 6;
+    }
+
+    // SaveState
+    //
+    // Stores each ball as three 16 bit fixed point values: height as a fraction of StartHeight, and
+    // velocity and launch speed in 1/4096ths.  Returns bytes written, or 0 if the buffer is too small.
+
+    size_t SaveState(uint8_t * buffer, size_t len) const
+    {
+        if (len < StateSize())
+            return 0;
+
+        for (size_t i = 0; i < _cBalls; i++)
+        {
+            uint16_t values[3] =
+            {
+                (uint16_t)(constrain(Height[i] / StartHeight, 0.0, 1.0) * 65535),
+                (uint16_t)(int16_t)(Velocity[i] * 4096),
+                (uint16_t)(int16_t)(LaunchSpeed[i] * 4096)
+            };
+
+            for (size_t v = 0; v < 3; v++)
+            {
+                *buffer++ = values[v] & 0xFF;
+                *buffer++ = values[v] >> 8;
+            }
+        }
+        return StateSize();
+    }
+
+    // LoadState
+    //
+    // Restores balls saved by SaveState().  Fails if the state was saved with a different ball count.
+
+    bool LoadState(const uint8_t * buffer, size_t len)
+    {
+        if (len != StateSize())
+            return false;
+
+        for (size_t i = 0; i < _cBalls; i++)
+        {
+            uint16_t values[3];
+            for (size_t v = 0; v < 3; v++, buffer += 2)
+                values[v] = buffer[0] | (buffer[1] << 8);
+
+            Height[i]      = values[0] * StartHeight / 65535;
+            PrevHeight[i]  = Height[i];
+            Velocity[i]    = (int16_t)values[1] / 4096.0f;
+            LaunchSpeed[i] = (int16_t)values[2] / 4096.0f;
+        }
+
+        _lastClock = UnixTime();                        // Don't simulate the time we were switched away
+        _accumulator = 0;
+        return true;
+    }
+
     // Draw
     //
-    // Draw each of the balls.  When any ball settles with too little energy, it it "kicked" to restart it
+    // Catch the simulation up to the current time, then draw each ball at a position interpolated
+    // between the last two physics steps.  Balls are drawn with DrawPixels so they land on sub-pixel
+    // positions and glide smoothly instead of jumping a whole pixel at a time.
 
     virtual void Draw()
     {
         if (_fadeRate != 0)
         {
-            for (size_t i = 0; i < _cLength; i++)
-                FastLED.leds()[i].fadeToBlackBy(_fadeRate);
+            kernel_fade8((uint8_t *)FastLED.leds(), _cLength * 3, _fadeRate);
         }
         else
             FastLED.clear();
-        
-        // Draw each of the balls
 
-        for (size_t i = 0; i < _cBalls; i++)
-        {
-            double TimeSinceLastBounce = (UnixTime() - ClockTimeAtLastBounce[i]) / SpeedKnob;
+        Advance(UnixTime());
 
-            // Use standard constant acceleration function - https://en.wikipedia.org/wiki/Acceleration
-            Height[i] = 0.5 * Gravity * pow(TimeSinceLastBounce, 2.0) + BallSpeed[i] * TimeSinceLastBounce;
+        const float alpha = _accumulator / StepSeconds;
 
-            // Ball hits ground - bounce!
-            if (Height[i] < 0)
-            {
-                Height[i] = 0;
-                BallSpeed[i] = Dampening[i] * BallSpeed[i];
-                ClockTimeAtLastBounce[i] = UnixTime();
+        // Draw each of the balls
 
-                if (BallSpeed[i] < 0.01)
-                    BallSpeed[i] = InitialBallSpeed(StartHeight) * Dampening[i];
-            }
+        for (size_t i = 0; i < _cBalls; i++)
+        {
+            float height = PrevHeight[i] + (Height[i] - PrevHeight[i]) * alpha;
+            if (height > StartHeight)                       // Integration can overshoot the apex slightly
+                height = StartHeight;
 
-            size_t position = (size_t)(Height[i] * (_cLength - 1) / StartHeight);
+            float fPos   = height * (_cLength - 1) / StartHeight;
 
-            FastLED.leds()[position]   += Colors[i];
-            FastLED.leds()[position+1] += Colors[i];
+            DrawPixels(fPos, BallSize, Colors[i]);
 
             if (_bMirrored)
-            {
-                FastLED.leds()[_cLength - 1 - position] += Colors[i];
-                FastLED.leds()[_cLength - position]     += Colors[i];
-            }
+                DrawPixels(_cLength - 1 - fPos, BallSize, Colors[i]);
         }
-        delay(20);
     }
 };
 
@@ -0,0 +1,312 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef CLIP_H
+#define CLIP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* *
+ * Pre-rendered animation clip format. All values are little endian.
+ *
+ * Header, 16 bytes
+ *      0   "LCLP"
+ *      4   Version
+ *      5   Flags
+ *      6   Pixels per frame (16bit)
+ *      8   Number of frames (16bit)
+ *      10  Frame interval in milliseconds (16bit)
+ *      12  Number of palette entries (16bit), 0 without CLIP_FLAG_PALETTE
+ *      14  Reserved
+ *
+ * Palette, 3 bytes RGB per entry when CLIP_FLAG_PALETTE is set
+ *
+ * Frames, one after another. Each frame is a frame type byte followed by ops that together cover
+ * every pixel of the frame in order. An op byte is the op in its top 2 bits and the run length - 1
+ * in its low 6 bits:
+ *      CLIP_OP_LITERAL - Run of pixels, each one stored
+ *      CLIP_OP_REPEAT  - Run of pixels all set to one stored pixel
+ *      CLIP_OP_SKIP    - Run of pixels unchanged from the previous frame, only in delta frames
+ * A stored pixel is 3 bytes RGB, or a 1 byte palette index with CLIP_FLAG_PALETTE.
+ *
+ * The first frame is always a key frame so a clip can loop and be decoded from the start without
+ * any state but the previous frame, which is the frame buffer being decoded into.
+ * */
+#define CLIP_MAGIC                  "LCLP"
+#define CLIP_VERSION                1
+#define CLIP_HEADER_LEN             16
+
+#define CLIP_FLAG_PALETTE           0x01            // Pixels are palette indexes
+
+#define CLIP_FRAME_KEY              0x00            // Frame doesn't depend on the previous frame
+#define CLIP_FRAME_DELTA            0x01            // Frame is changes to the previous frame
+
+#define CLIP_OP_LITERAL             0x00
+#define CLIP_OP_REPEAT              0x40
+#define CLIP_OP_SKIP                0x80
+#define CLIP_OP_MASK                0xC0
+#define CLIP_RUN_MASK               0x3F
+#define CLIP_MAX_RUN                64
+
+
+/* *
+ * ClipDecoder - Streams the frames of a clip straight into a frame buffer.
+ *
+ * The clip is read in place, from flash on the Teensy, and decoding keeps no more state than the
+ * read position, so RAM use does not depend on the clip or strip size. Frames are decoded in
+ * order and the clip loops back to its first frame after the last one.
+ * */
+class ClipDecoder
+{
+
+private:
+    const uint8_t* m_data;                      // Clip
+    uint32_t m_size;                            // Clip size in bytes
+    const uint8_t* m_palette;                   // Palette or nullptr
+    uint16_t m_paletteCount;                    // Number of palette entries
+    uint16_t m_pixels;                          // Pixels per frame
+    uint16_t m_frames;                          // Number of frames
+    uint16_t m_frameMs;                         // Frame interval
+    uint32_t m_firstFrame;                      // Offset of the first frame
+    uint32_t m_pos;                             // Offset of the next frame
+    uint16_t m_frame;                           // Index of the next frame
+
+    static uint16_t read16(const uint8_t* p)
+    {
+        return p[0] | (p[1] << 8);
+    }
+
+    /**
+     * @brief readPixel - Reads a stored pixel
+     * @param rgb - Set to the pixel color
+     * @return false when the pixel is past the end of the clip or not in the palette
+     */
+    bool readPixel(uint8_t* rgb)
+    {
+        if(m_palette != nullptr) {
+
+            if(m_pos + 1 > m_size || m_data[m_pos] >= m_paletteCount) return false;
+
+            memcpy(rgb, &m_palette[m_data[m_pos++] * 3], 3);
+
+        } else {
+
+            if(m_pos + 3 > m_size) return false;
+
+            memcpy(rgb, &m_data[m_pos], 3);
+            m_pos += 3;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief decodeOp - Decodes one op of a frame
+     * @param type - Frame type
+     * @param leds - RGB frame buffer
+     * @param count - Number of pixels in the frame buffer
+     * @param p - Pixel the op starts at, advanced past the op
+     * @return false when the op is corrupt
+     */
+    bool decodeOp(uint8_t type, uint8_t* leds, uint16_t count, uint16_t* p)
+    {
+        if(m_pos >= m_size) return false;
+
+        uint8_t op = m_data[m_pos] & CLIP_OP_MASK;
+        uint16_t end = *p + (m_data[m_pos++] & CLIP_RUN_MASK) + 1;
+        uint8_t rgb[3];
+
+        if(end > m_pixels) return false;
+
+        if(op == CLIP_OP_LITERAL) {
+
+            for(; *p < end; (*p)++) {
+                if(!readPixel(rgb)) return false;
+                if(*p < count) memcpy(&leds[*p * 3], rgb, 3);
+            }
+
+        } else if(op == CLIP_OP_REPEAT) {
+
+            if(!readPixel(rgb)) return false;
+
+            for(; *p < end; (*p)++)
+                if(*p < count) memcpy(&leds[*p * 3], rgb, 3);
+
+        } else if(op == CLIP_OP_SKIP && type == CLIP_FRAME_DELTA) {
+
+            *p = end;
+
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+public:
+
+    ClipDecoder() :
+        m_data(nullptr),
+        m_size(0),
+        m_palette(nullptr),
+        m_paletteCount(0),
+        m_pixels(0),
+        m_frames(0),
+        m_frameMs(0),
+        m_firstFrame(0),
+        m_pos(0),
+        m_frame(0)
+    {
+
+    }
+
+    /**
+     * @brief begin - Starts decoding a clip from its first frame
+     * @param data - Clip
+     * @param size - Clip size in bytes
+     * @return false when data is not a valid clip
+     */
+    bool begin(const uint8_t* data, uint32_t size)
+    {
+        m_data = nullptr;
+
+        if(data == nullptr || size < CLIP_HEADER_LEN
+                || memcmp(data, CLIP_MAGIC, 4) != 0 || data[4] != CLIP_VERSION)
+            return false;
+
+        m_pixels = read16(&data[6]);
+        m_frames = read16(&data[8]);
+        m_frameMs = read16(&data[10]);
+        m_paletteCount = read16(&data[12]);
+        m_palette = (data[5] & CLIP_FLAG_PALETTE) ? &data[CLIP_HEADER_LEN] : nullptr;
+        m_firstFrame = CLIP_HEADER_LEN + (m_palette ? m_paletteCount * 3 : 0);
+
+        if(m_pixels == 0 || m_frames == 0 || m_firstFrame >= size
+                || data[m_firstFrame] != CLIP_FRAME_KEY
+                || (m_palette && (m_paletteCount == 0 || m_paletteCount > 256)))
+            return false;
+
+        m_data = data;
+        m_size = size;
+        restart();
+        return true;
+    }
+
+    /**
+     * @brief restart - Continue from the first frame
+     */
+    void restart()
+    {
+        m_pos = m_firstFrame;
+        m_frame = 0;
+    }
+
+    /**
+     * @brief nextFrame - Decodes the next frame into the frame buffer. Delta frames are applied to
+     * whatever the frame buffer holds, which is the previous frame as long as nothing else drew
+     * into it. Pixels past the end of the frame buffer are decoded but not written.
+     * @param leds - RGB frame buffer, 3 bytes per pixel
+     * @param count - Number of pixels in the frame buffer
+     * @return false when the clip is corrupt, decoding starts over from the first frame
+     */
+    bool nextFrame(uint8_t* leds, uint16_t count)
+    {
+        if(m_data == nullptr) return false;
+
+        if(m_frame >= m_frames) restart();
+
+        if(m_pos >= m_size) {
+            restart();
+            return false;
+        }
+
+        uint8_t type = m_data[m_pos++];
+        uint16_t p = 0;
+
+        while(p < m_pixels && decodeOp(type, leds, count, &p)) { }
+
+        if(p != m_pixels) {
+            restart();
+            return false;
+        }
+
+        m_frame++;
+        return true;
+    }
+
+    /**
+     * @brief applyOps - Applies a run of delta frame ops with RGB pixels to a frame buffer, the way
+     * streamed frames are sent in pieces
+     * @param ops - Ops, without a frame type
+     * @param len - Length of ops
+     * @param leds - RGB frame buffer, 3 bytes per pixel
+     * @param first - Pixel the first op starts at
+     * @param count - Number of pixels in the frame buffer
+     * @return Pixel after the last one covered or -1 when the ops are corrupt or run past count
+     */
+    static int32_t applyOps(const uint8_t* ops, uint32_t len, uint8_t* leds, uint16_t first, uint16_t count)
+    {
+        ClipDecoder decoder;
+        decoder.m_data = ops;
+        decoder.m_size = len;
+        decoder.m_pixels = count;
+
+        uint16_t p = first;
+
+        while(decoder.m_pos < len)
+            if(!decoder.decodeOp(CLIP_FRAME_DELTA, leds, count, &p)) return -1;
+
+        return p;
+    }
+
+    bool valid() const
+    {
+        return m_data != nullptr;
+    }
+
+    uint16_t pixels() const
+    {
+        return m_pixels;
+    }
+
+    uint16_t frames() const
+    {
+        return m_frames;
+    }
+
+    uint16_t frameMs() const
+    {
+        return m_frameMs;
+    }
+
+    /**
+     * @brief frame - Get the index of the next frame to be decoded
+     * @return
+     */
+    uint16_t frame() const
+    {
+        return m_frame;
+    }
+
+};
+
+#endif // CLIP_H
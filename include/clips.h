@@ -0,0 +1,366 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef CLIPS_H
+#define CLIPS_H
+
+#include <stdint.h>
+
+
+/* *
+ * Clips played by the CLIP effect. Clip arrays are generated with tools/clipenc -c and, being
+ * const, stay in flash.
+ * */
+
+// clipenc -g comet -n 300 -F 240 -f 16 -p -c CLIP_COMET
+const uint8_t CLIP_COMET[5017] = {
+    0x4C, 0x43, 0x4C, 0x50, 0x01, 0x01, 0x2C, 0x01, 0xF0, 0x00, 0x10, 0x00, 0x07, 0x00, 0x00, 0x00,
+    0xFF, 0xC8, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x64, 0x00, 0x1F, 0x19, 0x00, 0x3F, 0x32, 0x00, 0x0F,
+    0x0C, 0x00, 0x07, 0x06, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x01, 0x7F, 0x01, 0x7F, 0x01, 0x7F, 0x01,
+    0x6A, 0x01, 0x01, 0x03, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0xA7, 0x01, 0x06, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0xA4, 0x01, 0x09, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0xA1, 0x01, 0x0C, 0x01, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x9E,
+    0x01, 0x43, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBF, 0xBF, 0x9B, 0x01, 0x83, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x98, 0x01, 0x86, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF,
+    0x95, 0x01, 0x89, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x92, 0x01, 0x8C, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x8F, 0x01, 0x8F, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0xBF, 0x8C, 0x01, 0x92, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x89, 0x01, 0x95, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x86, 0x01,
+    0x98, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBF, 0xBF, 0x83, 0x01, 0x9B, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x00, 0x01, 0x01, 0x9E, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF,
+    0xBD, 0x01, 0xA1, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBA, 0x01, 0xA4, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xB7, 0x01, 0xA7, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xB4,
+    0x01, 0xAA, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xBF, 0xBF, 0xB1, 0x01, 0xAD, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xAE, 0x01, 0xB0, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xAB, 0x01,
+    0xB3, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBF, 0xA8, 0x01, 0xB6, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xA5, 0x01, 0xB9, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xA2, 0x01, 0xBC,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0xBF, 0xBF, 0x9F, 0x01, 0xBF, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x9C, 0x01, 0xBF, 0x82, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x99, 0x01, 0xBF,
+    0x85, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBF, 0x96, 0x01, 0xBF, 0x88, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x93, 0x01, 0xBF, 0x8B, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x90,
+    0x01, 0xBF, 0x8E, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x8D, 0x01, 0xBF, 0x91, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x8A, 0x01, 0xBF, 0x94, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0x87, 0x01, 0xBF, 0x97, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x84, 0x01, 0xBF, 0x9A, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x81, 0x01, 0xBF,
+    0x9D, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBE, 0x01, 0xBF, 0xA0, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBB, 0x01, 0xBF, 0xA3, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xB8, 0x01, 0xBF, 0xA6,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0xBF, 0xB5, 0x01, 0xBF, 0xA9, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xB2, 0x01, 0xBF, 0xAC, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xAF, 0x01, 0xBF, 0xAF, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xAC, 0x01, 0xBF, 0xB2, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0xA9, 0x01, 0xBF, 0xB5, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xA6, 0x01, 0xBF, 0xB8, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xA3,
+    0x01, 0xBF, 0xBB, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xA0, 0x01, 0xBF, 0xBE, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x9D, 0x01, 0xBF, 0xBF, 0x81, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x9A,
+    0x01, 0xBF, 0xBF, 0x84, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0x97, 0x01, 0xBF, 0xBF, 0x87, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x94, 0x01, 0xBF, 0xBF, 0x8A,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0xBF, 0x91, 0x01, 0xBF, 0xBF, 0x8D, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x8E, 0x01, 0xBF, 0xBF, 0x90, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x8B, 0x01, 0xBF,
+    0xBF, 0x93, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xBF, 0x88, 0x01, 0xBF, 0xBF, 0x96, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x85, 0x01, 0xBF, 0xBF, 0x99, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0x82,
+    0x01, 0xBF, 0xBF, 0x9C, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0x01, 0xBF, 0xBF, 0x9F, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBC, 0x01, 0xBF, 0xBF, 0xA2, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xB9, 0x01,
+    0xBF, 0xBF, 0xA5, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xB6, 0x01, 0xBF, 0xBF, 0xA8, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xB3, 0x01, 0xBF, 0xBF, 0xAB, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xB0, 0x01, 0xBF,
+    0xBF, 0xAE, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xAD, 0x01, 0xBF, 0xBF, 0xB1, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xAA, 0x01, 0xBF, 0xBF, 0xB4, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xA7, 0x01, 0xBF, 0xBF,
+    0xB7, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xA4, 0x01, 0xBF, 0xBF, 0xBA, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xA1, 0x01, 0xBF, 0xBF, 0xBD, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x9E, 0x01, 0xBF, 0xBF, 0xBF,
+    0x43, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0x9B, 0x01, 0xBF, 0xBF, 0xBF, 0x83, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x98, 0x01, 0xBF, 0xBF, 0xBF, 0x86, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x95, 0x01, 0xBF, 0xBF,
+    0xBF, 0x89, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0x92, 0x01, 0xBF, 0xBF, 0xBF, 0x8C, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x8F, 0x01, 0xBF, 0xBF, 0xBF, 0x8F, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x8C, 0x01,
+    0xBF, 0xBF, 0xBF, 0x92, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0x89, 0x01, 0xBF, 0xBF, 0xBF, 0x95, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x86, 0x01, 0xBF, 0xBF, 0xBF, 0x98,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0x83, 0x01, 0xBF, 0xBF, 0xBF, 0x9B, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0x00, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0x9E, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBD, 0x01, 0xBF, 0xBF,
+    0xBF, 0xA1, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBA, 0x01, 0xBF, 0xBF, 0xBF, 0xA4, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xB7, 0x01, 0xBF, 0xBF, 0xBF, 0xA7, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xB4, 0x01, 0xBF, 0xBF, 0xBF,
+    0xAA, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xB1, 0x01, 0xBF, 0xBF, 0xBF, 0xAD, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xAE, 0x01, 0xBF, 0xBF, 0xBF, 0xB0, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xAB, 0x01, 0xBF, 0xBF, 0xBF, 0xB3,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xA8,
+    0x01, 0xBF, 0xBF, 0xBF, 0xB6, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xA5, 0x01, 0xBF, 0xBF, 0xBF, 0xB9, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xA2, 0x01, 0xBF, 0xBF, 0xBF, 0xBC, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x9F, 0x01,
+    0xBF, 0xBF, 0xBF, 0xBF, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x9C, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x82, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x99, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x85,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x96,
+    0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x88, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x93, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x8B, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x90, 0x01, 0xBF, 0xBF, 0xBF,
+    0xBF, 0x8E, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x8D, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x91, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x8A, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x94, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x87, 0x01, 0xBF,
+    0xBF, 0xBF, 0xBF, 0x97, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x84, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x9A, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x81, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x9D,
+    0x0D, 0x01, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x01, 0x01,
+    0xBF, 0xBF, 0xBF, 0xBF, 0x9B, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0x43, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x98, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x46, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x95, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x49, 0x01, 0x01, 0xBF,
+    0xBF, 0xBF, 0xBF, 0x92, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x4C, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x8F, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x4F, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x8C, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x52, 0x01, 0x01, 0xBF, 0xBF,
+    0xBF, 0xBF, 0x89, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x55, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x86, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x58, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBF, 0x83, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x5B, 0x01, 0x01, 0xBF, 0xBF, 0xBF,
+    0xBF, 0x0C, 0x01, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x5E,
+    0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBD, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x61, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xBA, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x64, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xB7, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x67, 0x01, 0x01, 0xBF, 0xBF,
+    0xBF, 0xB4, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x6A,
+    0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xB1, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x6D, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xAE, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x70, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xAB, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x73, 0x01, 0x01, 0xBF, 0xBF,
+    0xBF, 0xA8, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x76,
+    0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xA5, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x79, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0xA2, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7C, 0x01, 0x01, 0xBF, 0xBF, 0xBF, 0x9F, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x01, 0xBF, 0xBF,
+    0xBF, 0x9C, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F,
+    0x01, 0x82, 0x01, 0xBF, 0xBF, 0xBF, 0x99, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x85, 0x01, 0xBF, 0xBF, 0xBF, 0x96, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x88, 0x01, 0xBF, 0xBF, 0xBF,
+    0x93, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01,
+    0x8B, 0x01, 0xBF, 0xBF, 0xBF, 0x90, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x7F, 0x01, 0x8E, 0x01, 0xBF, 0xBF, 0xBF, 0x8D, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x91, 0x01, 0xBF, 0xBF, 0xBF, 0x8A,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x94,
+    0x01, 0xBF, 0xBF, 0xBF, 0x87, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0x7F, 0x01, 0x97, 0x01, 0xBF, 0xBF, 0xBF, 0x84, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x9A, 0x01, 0xBF, 0xBF, 0xBF, 0x81, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0x9D, 0x01,
+    0xBF, 0xBF, 0xBE, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xA0, 0x01, 0xBF, 0xBF, 0xBB, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xA3, 0x01, 0xBF, 0xBF, 0xB8, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xA6, 0x01, 0xBF, 0xBF, 0xB5, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xA9, 0x01,
+    0xBF, 0xBF, 0xB2, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xAC, 0x01, 0xBF, 0xBF, 0xAF, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xAF, 0x01, 0xBF, 0xBF, 0xAC, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xB2, 0x01, 0xBF, 0xBF, 0xA9, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xB5, 0x01,
+    0xBF, 0xBF, 0xA6, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xB8, 0x01, 0xBF, 0xBF, 0xA3, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBB, 0x01, 0xBF, 0xBF, 0xA0, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBE, 0x01, 0xBF, 0xBF, 0x9D, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x81,
+    0x01, 0xBF, 0xBF, 0x9A, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x7F, 0x01, 0xBF, 0x84, 0x01, 0xBF, 0xBF, 0x97, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x87, 0x01, 0xBF, 0xBF, 0x94, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x8A, 0x01,
+    0xBF, 0xBF, 0x91, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xBF, 0x8D, 0x01, 0xBF, 0xBF, 0x8E, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x90, 0x01, 0xBF, 0xBF, 0x8B, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x93, 0x01, 0xBF,
+    0xBF, 0x88, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F,
+    0x01, 0xBF, 0x96, 0x01, 0xBF, 0xBF, 0x85, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x99, 0x01, 0xBF, 0xBF, 0x82, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0x9C, 0x01, 0xBF, 0xBF,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF,
+    0x9F, 0x01, 0xBF, 0xBC, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x7F, 0x01, 0xBF, 0xA2, 0x01, 0xBF, 0xB9, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xA5, 0x01, 0xBF, 0xB6, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xA8, 0x01, 0xBF, 0xB3,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF,
+    0xAB, 0x01, 0xBF, 0xB0, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x7F, 0x01, 0xBF, 0xAE, 0x01, 0xBF, 0xAD, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xB1, 0x01, 0xBF, 0xAA, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xB4, 0x01, 0xBF, 0xA7,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF,
+    0xB7, 0x01, 0xBF, 0xA4, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x7F, 0x01, 0xBF, 0xBA, 0x01, 0xBF, 0xA1, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBD, 0x01, 0xBF, 0x9E, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x00, 0x01, 0x01,
+    0xBF, 0x9B, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F,
+    0x01, 0xBF, 0xBF, 0x83, 0x01, 0xBF, 0x98, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x86, 0x01, 0xBF, 0x95, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x89, 0x01, 0xBF,
+    0x92, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01,
+    0xBF, 0xBF, 0x8C, 0x01, 0xBF, 0x8F, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x8F, 0x01, 0xBF, 0x8C, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x92, 0x01, 0xBF, 0x89,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF,
+    0xBF, 0x95, 0x01, 0xBF, 0x86, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x98, 0x01, 0xBF, 0x83, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0x9B, 0x01, 0xBF, 0x0C, 0x01,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0x9E, 0x01, 0xBD, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xBF, 0xBF, 0xA1, 0x01, 0xBA, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xA4, 0x01, 0xB7, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xA7, 0x01, 0xB4, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0xAA, 0x01, 0xB1, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xBF, 0xBF, 0xAD, 0x01, 0xAE, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xB0, 0x01, 0xAB, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xB3, 0x01, 0xA8, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0xB6, 0x01, 0xA5, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xBF, 0xBF, 0xB9, 0x01, 0xA2, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBC, 0x01, 0x9F, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x01, 0x9C, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0xBF, 0x82, 0x01, 0x99, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x85, 0x01, 0x96, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x88, 0x01, 0x93, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF,
+    0x8B, 0x01, 0x90, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x8E, 0x01, 0x8D, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x91, 0x01, 0x8A, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x94,
+    0x01, 0x87, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F,
+    0x01, 0xBF, 0xBF, 0xBF, 0x97, 0x01, 0x84, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x9A, 0x01, 0x81, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0x9D, 0x01,
+    0x0A, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0xBF, 0xA0, 0x01, 0x07, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF,
+    0xBF, 0xA3, 0x01, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0xA6, 0x01,
+    0x01, 0x00, 0x00, 0x7F, 0x01, 0xBF, 0xBF, 0xBF, 0xA9, 0x01, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0xBF, 0xA8, 0x01, 0x05, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0xA5,
+    0x01, 0x08, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0xA2,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0xBF, 0x9F, 0x01, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x9C, 0x01, 0x82, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x99, 0x01, 0x85,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0xBF, 0xBF, 0xBF, 0x96, 0x01, 0x88, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04,
+    0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x93, 0x01, 0x8B, 0x42, 0x01, 0x0B, 0x06,
+    0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x90,
+    0x01, 0x8E, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x8D, 0x01, 0x91, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x8A, 0x01, 0x94, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF,
+    0xBF, 0x87, 0x01, 0x97, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x84, 0x01, 0x9A, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBF, 0x81, 0x01, 0x9D,
+    0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF,
+    0xBF, 0xBF, 0xBE, 0x01, 0xA0, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xBB, 0x01, 0xA3, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05,
+    0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xB8, 0x01, 0xA6, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0xB5, 0x01, 0xA9, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02,
+    0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xB2, 0x01, 0xAC, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xAF, 0x01, 0xAF, 0x42, 0x01,
+    0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF,
+    0xAC, 0x01, 0xB2, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xA9, 0x01, 0xB5, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xA6, 0x01, 0xB8, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0xA3,
+    0x01, 0xBB, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xBF, 0xBF, 0xA0, 0x01, 0xBE, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x9D, 0x01, 0xBF, 0x81, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x9A,
+    0x01, 0xBF, 0x84, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x97, 0x01, 0xBF, 0x87, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05,
+    0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x94, 0x01, 0xBF, 0x8A, 0x42,
+    0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF,
+    0xBF, 0x91, 0x01, 0xBF, 0x8D, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04,
+    0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x8E, 0x01, 0xBF, 0x90, 0x42, 0x01, 0x0B, 0x06, 0x06,
+    0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x8B, 0x01, 0xBF,
+    0x93, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00,
+    0xBF, 0xBF, 0xBF, 0x88, 0x01, 0xBF, 0x96, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x85, 0x01, 0xBF, 0x99, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x82,
+    0x01, 0xBF, 0x9C, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02,
+    0x00, 0x00, 0xBF, 0xBF, 0xBF, 0x01, 0xBF, 0x9F, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03,
+    0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xBC, 0x01, 0xBF, 0xA2, 0x42, 0x01, 0x0B,
+    0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xB9, 0x01,
+    0xBF, 0xA5, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03, 0x04, 0x04, 0x02, 0x02, 0x00,
+    0x00, 0xBF, 0xBF, 0xB6, 0x01, 0xBF, 0xA8, 0x42, 0x01, 0x0B, 0x06, 0x06, 0x05, 0x05, 0x03, 0x03,
+    0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0xBF, 0xBF, 0xB3,
+};
+
+
+/* *
+ * Clip table, indexed by the Set Clip command
+ * */
+typedef struct clip_entry_struct
+{
+    const uint8_t* data;                    // Encoded clip
+    uint32_t size;                          // Clip size in bytes
+} clip_entry_t;
+
+const clip_entry_t CLIPS[] =
+{
+    { CLIP_COMET,   sizeof(CLIP_COMET) },
+};
+
+#define CLIP_COUNT                  (sizeof(CLIPS) / sizeof(CLIPS[0]))
+
+#endif // CLIPS_H
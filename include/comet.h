@@ -19,18 +19,29 @@
 #define FASTLED_INTERNAL
 #include <FastLED.h>
 
+#include "kernels.h"
+
 
 
 class Comet
 {
 
+public:
+    static const int Size = 5;              // Pixels in the comet's head
+
 private:
+    static const byte FadeAmount = 96;      // Fade of the pixels picked to fade each frame
+
     byte m_hue;
+    int m_direction;
+    int m_position;
 
 public:
 
     Comet(byte hue = HUE_RED):
-        m_hue(hue)
+        m_hue(hue),
+        m_direction(1),
+        m_position(0)
     {
 
     }
@@ -56,31 +67,105 @@ public:
         m_hue = hue;
     }
 
+    /**
+     * @brief StateSize - Number of bytes SaveState() needs
+     * @return
+     */
+    size_t StateSize() const
+    {
+        return 4;
+    }
+
+    /**
+     * @brief SaveState - Save comet position, direction and hue
+     * @param buffer
+     * @param len
+     * @return Bytes written, 0 if buffer is too small
+     */
+    size_t SaveState(uint8_t* buffer, size_t len) const
+    {
+        if(len < StateSize())
+            return 0;
+
+        buffer[0] = m_position & 0xFF;
+        buffer[1] = (m_position >> 8) & 0xFF;
+        buffer[2] = (uint8_t)(int8_t)m_direction;
+        buffer[3] = m_hue;
+        return StateSize();
+    }
+
+    /**
+     * @brief LoadState - Restore state saved by SaveState()
+     * @param buffer
+     * @param len
+     * @return false if buffer does not hold a comet state
+     */
+    bool LoadState(const uint8_t* buffer, size_t len)
+    {
+        if(len != StateSize())
+            return false;
+
+        m_position = buffer[0] | (buffer[1] << 8);
+        m_direction = (int8_t)buffer[2];
+        m_hue = buffer[3];
+        return true;
+    }
+
     /**
      * @brief DrawComet - Draw commet
      */
     void DrawComet()
     {
-        const byte fadeAmt = 96;
-        const int cometSize = 5;
+        int numLeds = FastLED.size();
 
-        static int iDirection = 1;
-        static int iPos = 0;
+        m_position += m_direction;
+        if (m_position >= (numLeds - Size) || m_position <= 0)
+        {
+            m_position = constrain(m_position, 0, numLeds - Size);
+            m_direction = (m_position == 0) ? 1 : -1;
+        }
 
-        int numLeds = FastLED.size();
-        CRGB* leds = FastLED.leds();
+        kernel_fill_hue((uint8_t *)&FastLED.leds()[m_position], Size, m_hue);
+        FadeTail();
+    }
+
+    /**
+     * @brief DrawCometAt - Draw the comet with its head moved straight to a position, for a comet
+     * moved by more than a pixel a frame. The head is drawn over every pixel it passed so the tail
+     * has no gaps.
+     * @param position - First pixel of the head, 0 to the strip length - Size
+     */
+    void DrawCometAt(int position)
+    {
+        int last = max(FastLED.size() - Size, 0);
+        int previous = constrain(m_position, 0, last);
+        position = constrain(position, 0, last);
+
+        if (position != previous)
+            m_direction = position > previous ? 1 : -1;
 
-        iPos += iDirection;
-        if (iPos == (numLeds - cometSize) || iPos == 0)
-            iDirection *= -1;
+        int from = min(previous, position);
+        int to = max(previous, position);
 
-        for (int i = 0; i < cometSize; i++)
-            leds[iPos + i].setHue(m_hue);
+        kernel_fill_hue((uint8_t *)&FastLED.leds()[from], to - from + Size, m_hue);
+        m_position = position;
+        FadeTail();
+    }
+
+private:
+
+    /**
+     * @brief FadeTail - Randomly fade 40% of the LEDs. random8() rather than random(10), which
+     * divides for every LED.
+     */
+    void FadeTail()
+    {
+        int numLeds = FastLED.size();
+        CRGB* leds = FastLED.leds();
 
-        // Randomly fade the LEDs
         for (int j = 0; j < numLeds; j++)
-            if (random(10) > 5)
-                leds[j] = leds[j].fadeToBlackBy(fadeAmt);
+            if (random8() < 102)
+                leds[j].fadeToBlackBy(FadeAmount);
     }
 
 };
@@ -0,0 +1,540 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <stdint.h>
+#include "config.h"
+#include "protocol.h"
+
+
+/* *
+ * Commands - The command codes, effect codes and command table of the LED strip protocol.
+ *
+ * Shared by the firmware and the host tools that stand in for it, so both answer the same
+ * commands with the same param specs, coalescing and feature set.
+ * */
+
+#define MAX_COALESCED_ARGS          4                       // Max params of a coalesced command
+
+
+/* *
+ * Command print version
+ * */
+#define CMD_PRINT_VERSION               "CPV\0"
+
+/* *
+ * Command full reset - Reset the board - Not implemented
+ * */
+#define  CMD_FULL_RESET                 "CFR\0"
+
+/* *
+ * Command enter bootloader - Not implemented
+ * */
+#define  CMD_ENTER_BOOTLOADER           "CEB\0"
+
+/* *
+ * Command set debugging
+ * params
+ * - debugging enabled in HEX:
+ *       0x00 - off
+ *       0x01 - on
+ * */
+#define  CMD_SET_DEBUGGING              "CSD\0"
+
+/* *
+ * Command Set Effect - Sets the active LED strip effect
+ * params
+ * - effect code in HEX:
+ *      0x00 - Off
+ *      0x01 - Solid Color
+ *      0x02 - Rainbow Cycle
+ *      0x03 - Comet
+ *      0x04 - Comet Rainbow
+ *      0x05 - Fire
+ *      0x06 - Fire with color
+ *      0x07 - Solid Color Pulse
+ *      0x08 - Bouncing Ball
+ *      0x09 - Twinkle
+ *      0x0A - Clip
+ *      0x0B - Stream
+ *      0x0C - Spinner, on the rings set with Set Rings
+ *      0x0D - Radar, on the rings set with Set Rings
+ *      0x0E - Clock, on the rings set with Set Rings
+ * */
+#define  CMD_SET_EFFECT                 "CSE\0"
+
+/* *
+ * Command Set Color - Sets the base color for effects that use an input color
+ * params
+ * - Color code 24bit RGB in HEX
+ * */
+#define CMD_SET_COLOR                   "CSC\0"
+
+/* *
+ * Command Set Brightness - Sets the brightness
+ * params
+ * - Brightness 0-255 in HEX
+ * */
+#define CMD_SET_BRIGHTNESS              "CSB\0"
+
+/* *
+ * Command Set Fire Color Pallet - Sets the active color pallet for FIRE_COLOR effect
+ * params
+ * - Pallet code in HEX:
+ *      0x00 - Heat
+ *      0x01 - Party
+ *      0x02 - Rainbow
+ *      0x03 - RainbowStripe
+ *      0x04 - Forest
+ *      0x05 - Ocean
+ *      0x06 - Lava
+ *      0x07 - Cloud
+ *      0x08 - Custom, set with Set Custom Pallet
+ * */
+#define CMD_SET_FIRE_COLOR_PALLET       "CSFP\0"
+
+/* *
+ * Command Set Custom Pallet - Sets the colors of the Custom pallet
+ * params
+ * - 1 to 16 color codes 24bit RGB in HEX. Fewer than 16 colors are stretched across the pallet.
+ * */
+#define CMD_SET_CUSTOM_PALLET           "CSCP\0"
+
+/* *
+ * Command Get Status - Gets the status of the LED Strip parameters
+ * response param
+ * - "DEBUGGING|EFFECT|BRIGHTNESS|COLOR|FIRE_COLOR_PALLET|LENGTH" in HEX
+ * */
+#define CMD_GET_STATUS                  "CGS\0"
+
+/* *
+ * Command Get Frame - Reads back the frame being displayed. The command is acknowledged with the
+ * number of pixels in the readback and the number of the frame read, and the pixels are then sent
+ * in chunks between frames, one chunk per response:
+ *      [CGF:0:PIXEL_COUNT|FRAME]
+ *      [CGF:0:FIRST_PIXEL:RUNS]
+ * Each run is a 1 byte run length followed by the run color, all in HEX. The readback is complete
+ * when the runs received cover PIXEL_COUNT pixels. The frame is copied when the command is
+ * received, so every chunk comes from frame FRAME while later frames are rendered. FRAME counts
+ * the frames shown and wraps at 0xFFFF, a Get Frame Checksum with the same FRAME was taken from
+ * the same frame.
+ * params
+ * - Source in HEX (optional, default 0x00):
+ *      0x00 - Frame buffer, before brightness
+ *      0x01 - Output, after brightness, power limiting and color correction
+ * - Encoding in HEX (optional, default 0x00):
+ *      0x00 - Runs of 24bit RGB
+ *      0x01 - Runs of 8bit 3-3-2 RGB
+ * - Downsample in HEX (optional, default 0x01): Number of LEDs averaged into each pixel
+ * */
+#define CMD_GET_FRAME                   "CGF\0"
+
+/* *
+ * Command Get Frame Checksum - Gets the CRC16 of the frame being displayed, the CRC16 of the RGB
+ * bytes of a Get Frame readback of the same FRAME with 24bit RGB runs and no downsampling
+ * params
+ * - Source in HEX, as for Get Frame (optional, default 0x00)
+ * response param
+ * - "CRC16|PIXEL_COUNT|FRAME" in HEX
+ * */
+#define CMD_GET_FRAME_CHECKSUM          "CGFC\0"
+
+/* *
+ * Command Get Telemetry - Gets render timing telemetry
+ * response param
+ * - "LAST|MAX|FPS|RENDER|SHOW|INTERVAL" in HEX:
+ *      LAST     - Latency from receipt of the last state changing command to the start of the
+ *                 show that displayed it in microseconds
+ *      MAX      - Max latency since the previous Get Telemetry command in microseconds
+ *      FPS      - FastLED frames per second
+ *      RENDER   - Time the last frame took to render in microseconds
+ *      SHOW     - Time the last frame took to show in microseconds
+ *      INTERVAL - Frame interval the active effect is tuned to in milliseconds
+ * */
+#define CMD_GET_TELEMETRY               "CGT\0"
+
+/* *
+ * Command Get Protocol Stats - Gets the command protocol's counters. They count from startup and
+ * wrap, so hosts work with the difference between two reads.
+ * params
+ * - Command code to get the counters of (optional)
+ * response param, without a command
+ * - "BYTES|PACKETS|OVERFLOWS|CRC|WASTED" in HEX:
+ *      BYTES     - Bytes received
+ *      PACKETS   - Packets received, whether they parsed or not
+ *      OVERFLOWS - Times the input buffer overflowed
+ *      CRC       - CRC16 mismatches
+ *      WASTED    - Bytes thrown away resynchronizing after noise, lost CRs and overflows
+ * - Count of each error code responded with, from -100 to -113, in HEX separated by |
+ * response param, with a command
+ * - "PACKETS|HANDLER|MAX" in HEX:
+ *      PACKETS   - Packets received for the command
+ *      HANDLER   - Total time its handler ran in microseconds
+ *      MAX       - Longest its handler ran in microseconds
+ * */
+#define CMD_GET_PROTO_STATS             "CGPS\0"
+
+/* *
+ * Command Freeze - Freezes or resumes the effect clock. While frozen input is still handled but
+ * frames are only rendered by Frame Step, and state changes are shown without rendering a frame.
+ * params
+ * - Freeze in HEX:
+ *      0x00 - Resume
+ *      0x01 - Freeze
+ * - Random seed in HEX (optional). Seeds the random number generators so stepped frames can be
+ *   reproduced.
+ * */
+#define CMD_FREEZE                      "CFZ\0"
+
+/* *
+ * Command Frame Step - Renders frames while the effect clock is frozen, advancing the clock by
+ * the effect's frame interval for each one. Freezes the effect clock if it is running.
+ * params
+ * - Number of frames in HEX (optional, default 0x01)
+ * */
+#define CMD_FRAME_STEP                  "CFS\0"
+
+/* *
+ * Command Set Recording - Starts or stops recording received packets. Starting clears the previous
+ * recording. Recording commands are not recorded.
+ * params
+ * - Record in HEX:
+ *      0x00 - Stop
+ *      0x01 - Start
+ * */
+#define CMD_SET_RECORDING               "CSR\0"
+
+/* *
+ * Command Get Recording - Gets a recorded packet
+ * params
+ * - Record index in HEX (optional)
+ * response params
+ * - Without an index "COUNT|DROPPED|RECORDING" in HEX:
+ *      COUNT     - Number of recorded packets
+ *      DROPPED   - Packets not recorded because the recorder was full
+ *      RECORDING - 0x01 while recording
+ * - With an index
+ *      Receipt time in microseconds since recording started in HEX
+ *      Packet body, everything between STX and ETX
+ * */
+#define CMD_GET_RECORDING               "CGR\0"
+
+/* *
+ * Command Set Clip - Sets the pre-rendered clip played by the Clip effect
+ * params
+ * - Clip index in HEX
+ * */
+#define CMD_SET_CLIP                    "CSCL\0"
+
+/* *
+ * Command Write Frame - Writes pixels of a streamed frame to the stream buffer. The Stream effect
+ * shows the stream buffer each time a frame is presented.
+ * params
+ * - First pixel in HEX
+ * - Flags in HEX:
+ *      0x01 - Data is delta ops (see clip.h) applied to the frame in the stream buffer, otherwise
+ *             it is 24bit RGB pixels
+ *      0x02 - Present the frame after writing the data
+ * - Data in HEX, may be empty
+ * - Frame timestamp in milliseconds in HEX (optional). Sets how long stream interpolation takes
+ *   to reach a presented frame, otherwise the time since the previous frame arrived is used.
+ * */
+#define CMD_WRITE_FRAME                 "CWF\0"
+
+#define WRITE_FRAME_DELTA               0x01
+#define WRITE_FRAME_PRESENT             0x02
+
+/* *
+ * Command Set Stream Interpolation - Sets how the Stream effect shows presented frames. While
+ * interpolating the effect renders at its full frame rate, blending from the frame shown to each
+ * presented frame, so the host can stream at a fraction of the frame rate.
+ * params
+ * - Mode in HEX:
+ *      0x00 - Off, frames are shown as they are presented
+ *      0x01 - Linear, blend the RGB values
+ *      0x02 - Perceptual, blend evenly in perceived brightness
+ * */
+#define CMD_SET_STREAM_INTERPOLATION    "CSSI\0"
+
+/* *
+ * Command Set Length - Sets the number of LEDs on the strip, MIN_LEDS (8) to MAX_LEDS. Only that
+ * many are rendered and shown, and the active effect restarts sized to the new length.
+ * params
+ * - Number of LEDs in HEX
+ * */
+#define CMD_SET_LENGTH                  "CSL\0"
+
+/* *
+ * Command Set Tempo - Sets the tempo effects lock to while tempo sync is on. The beat clock runs
+ * on its own from then on, the host only sends tempo changes.
+ * params
+ * - BPM * 100 in HEX, 0x07D0 (20 BPM) to 0x7530 (300 BPM)
+ * - Point in the current beat in HEX, 0x0000 at its start to 0xFFFF at its end (optional). Lines
+ *   the beat up with the host's.
+ * - Beats per bar in HEX, 0x01 to 0x10 (optional)
+ * */
+#define CMD_SET_TEMPO                   "CST\0"
+
+/* *
+ * Command Tap Tempo - Taps a beat. Each tap moves the beat clock to the nearest beat, and from the
+ * second tap on sets the tempo from the average interval of the last 8 taps. A pause of more than
+ * 2 seconds starts a new run of taps, whose first tap starts a bar.
+ * response param
+ * - "BPM" * 100 in HEX
+ * */
+#define CMD_TAP_TEMPO                   "CTT\0"
+
+/* *
+ * Command Set Tempo Sync - Locks effects to the tempo and renders a frame at the start of each
+ * beat:
+ *      Rainbow Cycle           - Goes round the hues once a bar
+ *      Comet, Comet Rainbow    - Sweeps the strip and back once a bar
+ *      Solid Color Pulse       - Peaks on each beat
+ *      Spinner                 - Turns once a bar
+ *      Radar                   - Sweeps round once a bar
+ * params
+ * - 0x00 off, 0x01 on in HEX
+ * */
+#define CMD_SET_TEMPO_SYNC              "CSTS\0"
+
+/* *
+ * Command Get Tempo - Gets the beat clock
+ * response param
+ * - "BPM|BEATS_PER_BAR|BEAT|BEAT_IN_BAR|BEAT_PHASE|SYNC" in HEX:
+ *      BPM         - Tempo, BPM * 100
+ *      BEAT        - Beat number, wraps at 0xFFFF
+ *      BEAT_IN_BAR - Beat of the bar, 0 is the first
+ *      BEAT_PHASE  - Point in the current beat, 0x0000 at its start to 0xFFFF at its end
+ * */
+#define CMD_GET_TEMPO                   "CGTP\0"
+
+/* *
+ * Command Set Rings - Describes the rings or fans of LEDs the Spinner, Radar and Clock effects
+ * draw on. Rings are wired one after another from the start of the strip.
+ * params
+ * - 1 to MAX_RINGS ring codes 0xSSOOFFRR in HEX:
+ *      SS - Number of LEDs
+ *      OO - LED at the top, counted from the ring's first in wiring order
+ *      FF - Flags, 0x01 if the ring is wired counterclockwise
+ *      RR - Distance from the centre, 0x00-0xFF. Concentric rings have increasing radii,
+ *           separate fans can share one.
+ * */
+#define CMD_SET_RINGS                   "CSRG\0"
+
+/* *
+ * Command Set Time - Sets the time of day the Clock effect shows
+ * params
+ * - Seconds since midnight in HEX, 0x00000000 to 0x0001517F
+ * */
+#define CMD_SET_TIME                    "CSTM\0"
+
+/* *
+ * Command Fade - Fades the brightness, and optionally the color, over up to 24 hours, for sunrise,
+ * sunset and dimming schedules. Levels between the 8bit steps are dithered over frames. Set
+ * Brightness and Set Color stop the fade of what they set. The levels are saved when the fade
+ * ends.
+ * params
+ * - Duration in milliseconds in HEX, 0x00000000 to 0x05265C00. 0 sets the levels now.
+ * - Brightness to end at, 0-255 in HEX
+ * - Color to end at, color code 24bit RGB in HEX
+ * */
+#define CMD_FADE                        "CFD\0"
+
+#define SECONDS_PER_DAY                 86400
+
+
+/* *
+ * LED Strip effects
+ * */
+typedef enum AvailableEffects
+{
+    OFF = 0x00,             // Off
+    SOLID_COLOR,            // Solid color
+    RAINBOW_CYCLE,          // Rainbow cycle
+    COMET,                  // Comet with static color
+    COMET_RAINBOW,          // Comet rainbow
+    FIRE,                   // Classic fire effect
+    FIRE_COLOR,             // Fire with color effect
+    SOLID_PULSE,            // Solid color pulse
+    BOUNCING_BALL,          // Bouncing ball
+    TWINKLE,                // Twinkle
+    CLIP,                   // Pre-rendered clip
+    STREAM,                 // Frames streamed by the host
+    SPINNER,                // Arcs turning round the rings
+    RADAR,                  // Radar sweep across the rings
+    CLOCK,                  // Clock hands across the rings
+    MAX_EFFECT,             // Easy reference to the number of effects
+} Effect_t;
+
+/**
+ * @brief effect_available - Get whether an effect is built into this configuration
+ * @param effect
+ * @return
+ */
+inline bool effect_available(uint8_t effect)
+{
+
+    switch(effect)
+    {
+    case AvailableEffects::COMET:
+    case AvailableEffects::COMET_RAINBOW:
+        return FEATURE_COMET;
+
+    case AvailableEffects::FIRE:            return FEATURE_FIRE;
+    case AvailableEffects::FIRE_COLOR:      return FEATURE_FIRE_COLOR;
+    case AvailableEffects::BOUNCING_BALL:   return FEATURE_BOUNCING_BALL;
+    case AvailableEffects::TWINKLE:         return FEATURE_TWINKLE;
+    case AvailableEffects::CLIP:            return FEATURE_CLIPS;
+    case AvailableEffects::STREAM:          return FEATURE_STREAM;
+
+    case AvailableEffects::SPINNER:
+    case AvailableEffects::RADAR:
+    case AvailableEffects::CLOCK:
+        return FEATURE_RINGS;
+
+    default:
+        return effect < AvailableEffects::MAX_EFFECT;
+    };
+}
+
+
+/* *
+ * Command handlers. The firmware defines them in main.cpp, and loadsim defines them again for its
+ * virtual controllers so it answers the same table.
+ * */
+void proc_print_version(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_not_implemented(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_debugging(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_active_effect(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_color(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_brightness(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#if FEATURE_FIRE_COLOR
+void proc_set_fire_color_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_custom_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+void proc_get_status(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_get_telemetry(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_get_proto_stats(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#if FEATURE_READBACK
+void proc_get_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+void proc_get_frame_checksum(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_freeze(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_frame_step(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#if FEATURE_RECORDER
+void proc_set_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_get_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+#if FEATURE_CLIPS
+void proc_set_clip(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+#if FEATURE_STREAM
+void proc_write_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_interpolation(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+void proc_set_length(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#if FEATURE_TEMPO
+void proc_set_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_tap_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_tempo_sync(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_get_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+#if FEATURE_RINGS
+void proc_set_rings(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+void proc_set_time(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+#if FEATURE_FADE
+void proc_fade(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+#endif
+
+
+/* *
+ * Command table. Params are parsed into typed values using each command's param spec before
+ * the handler is called and the param count is checked against each command's min and max.
+ * Coalesced commands only set a parameter and take at most MAX_COALESCED_ARGS params; when more
+ * than one of the same command is waiting to be applied only the newest is applied and the others
+ * are acknowledged with ERR_PROTO_COALESCED.
+ * */
+const proto_cmd_t COMMANDS[] =
+{
+    // name                         handler                     params  min max coalesce
+    { CMD_PRINT_VERSION,            proc_print_version,         "",     0,  0,  false },
+    { CMD_FULL_RESET,               proc_not_implemented,       "",     0,  0,  false },
+    { CMD_ENTER_BOOTLOADER,         proc_not_implemented,       "",     0,  0,  false },
+    { CMD_SET_DEBUGGING,            proc_set_debugging,         "D",    0,  1,  false },
+    { CMD_SET_EFFECT,               proc_set_active_effect,     "B",    1,  1,  true  },
+    { CMD_SET_COLOR,                proc_set_color,             "C",    1,  1,  true  },
+    { CMD_SET_BRIGHTNESS,           proc_set_brightness,        "B",    1,  1,  true  },
+#if FEATURE_FIRE_COLOR
+    { CMD_SET_FIRE_COLOR_PALLET,    proc_set_fire_color_pallet, "B",    1,  1,  true  },
+    { CMD_SET_CUSTOM_PALLET,        proc_set_custom_pallet,     "C",    1,  16, false },
+#endif
+    { CMD_GET_STATUS,               proc_get_status,            "",     0,  0,  false },
+    { CMD_GET_TELEMETRY,            proc_get_telemetry,         "",     0,  0,  false },
+    { CMD_GET_PROTO_STATS,          proc_get_proto_stats,       "S",    0,  1,  false },
+#if FEATURE_READBACK
+    { CMD_GET_FRAME,                proc_get_frame,             "BBB",  0,  3,  false },
+#endif
+    { CMD_GET_FRAME_CHECKSUM,       proc_get_frame_checksum,    "B",    0,  1,  false },
+    { CMD_FREEZE,                   proc_freeze,                "BL",   1,  2,  false },
+    { CMD_FRAME_STEP,               proc_frame_step,            "W",    0,  1,  false },
+#if FEATURE_RECORDER
+    { CMD_SET_RECORDING,            proc_set_recording,         "B",    1,  1,  false },
+    { CMD_GET_RECORDING,            proc_get_recording,         "W",    0,  1,  false },
+#endif
+#if FEATURE_CLIPS
+    { CMD_SET_CLIP,                 proc_set_clip,              "B",    1,  1,  false },
+#endif
+#if FEATURE_STREAM
+    { CMD_WRITE_FRAME,              proc_write_frame,           "WBSL", 2,  4,  false },
+    { CMD_SET_STREAM_INTERPOLATION, proc_set_interpolation,     "B",    1,  1,  false },
+#endif
+    { CMD_SET_LENGTH,               proc_set_length,            "W",    1,  1,  false },
+#if FEATURE_TEMPO
+    { CMD_SET_TEMPO,                proc_set_tempo,             "WWB",  1,  3,  false },
+    { CMD_TAP_TEMPO,                proc_tap_tempo,             "",     0,  0,  false },
+    { CMD_SET_TEMPO_SYNC,           proc_set_tempo_sync,        "B",    1,  1,  false },
+    { CMD_GET_TEMPO,                proc_get_tempo,             "",     0,  0,  false },
+#endif
+#if FEATURE_RINGS
+    { CMD_SET_RINGS,                proc_set_rings,             "L",    1,  MAX_RINGS,  false },
+    { CMD_SET_TIME,                 proc_set_time,              "L",    1,  1,  false },
+#endif
+#if FEATURE_FADE
+    { CMD_FADE,                     proc_fade,                  "LBC",  2,  3,  false },
+#endif
+};
+
+#define COMMAND_COUNT               (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+/* *
+ * Coalesced command waiting to be applied
+ * */
+typedef struct pending_cmd_struct
+{
+    bool pending;                                           // Waiting to be applied
+    uint8_t argc;                                           // Number of params
+    proto_arg_t args[MAX_COALESCED_ARGS];                   // Typed params
+    uint32_t receivedUs;                                    // Receipt time
+    uint32_t seq;                                           // Arrival order
+} pending_cmd_t;
+
+#endif // COMMANDS_H
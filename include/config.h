@@ -0,0 +1,106 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+
+/* *
+ * Build configuration - Selects the effects and subsystems built into the firmware.
+ *
+ * Each flag is 1 to build the feature in or 0 to leave it out, and defaults to 1. Override them
+ * with -D build flags, the environments in platformio.ini are the supported combinations. A
+ * feature left out drops its code, buffers, tables and commands from the image. Its effect
+ * codes and command codes stay reserved so hosts see the same codes on every build: Set Active
+ * Effect answers a left out effect with ERR_PROTO_CP_PARAM_OUT_RANGE and a left out command is
+ * unknown.
+ *
+ * The flags are plain constant expressions, so code that only reads a feature's state is kept
+ * compiled and guarded with if(FEATURE_*) for the optimizer to drop, and #if is kept for what
+ * won't compile without the feature.
+ * */
+
+#ifndef MAX_LEDS
+#define MAX_LEDS                    300                     // Longest strip, the active length is set at runtime
+#endif
+
+#define MIN_LEDS                    8                       // Shortest strip, the comet and fires need at least this many
+#define MAX_RINGS                   8                       // Most rings Set Rings can describe
+
+#ifndef FEATURE_COMET
+#define FEATURE_COMET               1                       // Comet and Comet Rainbow effects
+#endif
+
+#ifndef FEATURE_FIRE
+#define FEATURE_FIRE                1                       // Fire effect
+#endif
+
+#ifndef FEATURE_FIRE_COLOR
+#define FEATURE_FIRE_COLOR          1                       // Fire With Color effect and its pallet commands
+#endif
+
+#ifndef FEATURE_BOUNCING_BALL
+#define FEATURE_BOUNCING_BALL       1                       // Bouncing Ball effect
+#endif
+
+#ifndef FEATURE_TWINKLE
+#define FEATURE_TWINKLE             1                       // Twinkle effect
+#endif
+
+#ifndef FEATURE_CLIPS
+#define FEATURE_CLIPS               1                       // Clip effect and the built in clips
+#endif
+
+#ifndef FEATURE_STREAM
+#define FEATURE_STREAM              1                       // Stream effect, Write Frame and interpolation, 2 frame buffers more
+#endif
+
+#ifndef FEATURE_RINGS
+#define FEATURE_RINGS               1                       // Spinner, Radar and Clock effects and the ring geometry
+#endif
+
+#ifndef FEATURE_TEMPO
+#define FEATURE_TEMPO               1                       // Tempo clock and tempo synced effects
+#endif
+
+#ifndef FEATURE_FADE
+#define FEATURE_FADE                1                       // Long brightness and color fades
+#endif
+
+#ifndef FEATURE_READBACK
+#define FEATURE_READBACK            1                       // Get Frame readback
+#endif
+
+#ifndef FEATURE_RECORDER
+#define FEATURE_RECORDER            1                       // Received packet recorder, PACKET_RECORDER_SIZE bytes
+#endif
+
+#ifndef FEATURE_FAN_HELPERS
+#define FEATURE_FAN_HELPERS         1                       // Fixed fan pixel tables and drawing in ledgfx.h
+#endif
+
+// Effects whose state is saved for resuming them, the effect state cache is only built with one
+#define FEATURE_EFFECT_STATES       (FEATURE_COMET || FEATURE_FIRE || FEATURE_FIRE_COLOR || FEATURE_BOUNCING_BALL)
+
+// Bytes kept for resuming effects switched away from, both fires' heat at MAX_LEDS plus the comet and balls
+#ifndef EFFECT_STATE_CACHE_SIZE
+#define EFFECT_STATE_CACHE_SIZE     (MAX_LEDS + MAX_LEDS / 2 + 64)
+#endif
+
+#endif // CONFIG_H
@@ -0,0 +1,161 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef EFFECTARENA_H
+#define EFFECTARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+
+
+/* *
+ * Compile time maximum of sizeof() over a list of types. Used to size an EffectArena so it
+ * can hold the largest of the effects it will ever be asked to construct.
+ * */
+template<typename T, typename... Ts>
+struct MaxSizeOf
+{
+    static const size_t value = sizeof(T) > MaxSizeOf<Ts...>::value ? sizeof(T) : MaxSizeOf<Ts...>::value;
+};
+
+template<typename T>
+struct MaxSizeOf<T>
+{
+    static const size_t value = sizeof(T);
+};
+
+/* *
+ * Compile time maximum of a list of sizes. Used where the list of types depends on the build
+ * configuration, as a list of sizeof()s can be empty apart from a floor value.
+ * */
+template<size_t V, size_t... Vs>
+struct MaxValue
+{
+    static const size_t value = V > MaxValue<Vs...>::value ? V : MaxValue<Vs...>::value;
+};
+
+template<size_t V>
+struct MaxValue<V>
+{
+    static const size_t value = V;
+};
+
+
+/* *
+ * EffectArena - A single statically sized memory region effects are constructed into on demand.
+ *
+ * Objects are placement constructed one after another and destroyed together, newest first, by
+ * reset(). Only the active effect (or a few layered effects) exist at any one time so the RAM
+ * used is that of the largest effect rather than the sum of all effects.
+ * */
+template<size_t Capacity, uint8_t MaxObjects = 2>
+class EffectArena
+{
+
+private:
+    alignas(8) uint8_t m_buffer[Capacity];      // Backing storage for constructed effects
+    void* m_objects[MaxObjects];                // Constructed objects, oldest first
+    void (*m_destroy[MaxObjects])(void*);       // Destructor thunk for each constructed object
+    uint8_t m_count;                            // Number of live objects
+    size_t m_used;                              // Bytes of m_buffer in use
+
+    template<typename T>
+    static void destroy(void* obj)
+    {
+        static_cast<T*>(obj)->~T();
+    }
+
+public:
+
+    EffectArena() :
+        m_count(0),
+        m_used(0)
+    {
+
+    }
+
+    ~EffectArena()
+    {
+        reset();
+    }
+
+    EffectArena(const EffectArena&) = delete;
+    EffectArena& operator=(const EffectArena&) = delete;
+
+    /**
+     * @brief create - Construct an object of type T in the arena.
+     * @param args - Arguments forwarded to the T constructor.
+     * @return Pointer to the new object or nullptr when the arena does not have room for it.
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(alignof(T) <= 8, "EffectArena only guarantees 8 byte alignment");
+
+        size_t offset = (m_used + alignof(T) - 1) & ~(alignof(T) - 1);
+
+        if(m_count >= MaxObjects || offset + sizeof(T) > Capacity)
+            return nullptr;
+
+        T* obj = new (&m_buffer[offset]) T(std::forward<Args>(args)...);
+
+        m_objects[m_count] = obj;
+        m_destroy[m_count] = &EffectArena::destroy<T>;
+        m_count++;
+        m_used = offset + sizeof(T);
+
+        return obj;
+    }
+
+    /**
+     * @brief reset - Destroy every object in the arena, newest first, and release the memory.
+     */
+    void reset()
+    {
+        while(m_count > 0) {
+            m_count--;
+            m_destroy[m_count](m_objects[m_count]);
+        }
+
+        m_used = 0;
+    }
+
+    /**
+     * @brief used - Get the number of arena bytes in use.
+     * @return
+     */
+    size_t used() const
+    {
+        return m_used;
+    }
+
+    /**
+     * @brief capacity - Get the arena size in bytes.
+     * @return
+     */
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+
+};
+
+#endif // EFFECTARENA_H
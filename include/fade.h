@@ -0,0 +1,179 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef FADE_H
+#define FADE_H
+
+#include <stdint.h>
+
+
+#define FADE_MAX_MS                 86400000UL      // Longest fade, 24 hours
+
+
+/* *
+ * FadeChannel - Moves an 8bit level to a target over minutes to hours.
+ *
+ * The level is 8.48 fixed point. Starting a fade works out once how much it moves per
+ * millisecond, and each frame only adds that times the time since the last frame. At 48 bits of
+ * fraction a 1 level change spread over FADE_MAX_MS still moves every frame, so long fades
+ * don't stall between steps or arrive early.
+ *
+ * A level between two 8bit values is shown by dithering over frames: dithered() rounds up on the
+ * share of frames given by the fraction, picked by a frame number's bits reversed so the frames
+ * that round up are spread out rather than bunched. Shown often enough the eye averages them, so
+ * fades at low levels have no visible steps.
+ * */
+class FadeChannel
+{
+
+private:
+    static const uint8_t Shift = 48;                // Fraction bits of the level
+
+    uint64_t m_level;                               // Level, 8.48 fixed point
+    int64_t m_rate;                                 // Level change per millisecond
+    uint32_t m_remainingMs;                         // Time left of the fade, 0 when not fading
+    uint32_t m_lastMs;                              // Time of the last update
+    uint8_t m_target;                               // Level the fade ends at
+
+public:
+
+    FadeChannel() :
+        m_level(0),
+        m_rate(0),
+        m_remainingMs(0),
+        m_lastMs(0),
+        m_target(0)
+    {
+
+    }
+
+    /**
+     * @brief set - Sets the level, stopping any fade
+     * @param level
+     */
+    void set(uint8_t level)
+    {
+        m_level = (uint64_t)level << Shift;
+        m_rate = 0;
+        m_remainingMs = 0;
+        m_target = level;
+    }
+
+    /**
+     * @brief start - Starts a fade from the current level, carrying on from part way through any
+     * fade in progress
+     * @param target - Level to end at
+     * @param durationMs - Time the fade takes, at most FADE_MAX_MS. 0 sets the level now.
+     * @param nowMs - Current time
+     */
+    void start(uint8_t target, uint32_t durationMs, uint32_t nowMs)
+    {
+        if(durationMs == 0) {
+            set(target);
+            return;
+        }
+
+        if(durationMs > FADE_MAX_MS) durationMs = FADE_MAX_MS;
+
+        int64_t delta = ((int64_t)target << Shift) - (int64_t)m_level;
+        m_rate = delta / (int64_t)durationMs;
+        m_remainingMs = durationMs;
+        m_lastMs = nowMs;
+        m_target = target;
+    }
+
+    /**
+     * @brief update - Advances the fade to the current time, landing exactly on the target when it
+     * ends
+     * @param nowMs - Current time
+     * @return true if the fade ended
+     */
+    bool update(uint32_t nowMs)
+    {
+        if(m_remainingMs == 0)
+            return false;
+
+        uint32_t elapsed = nowMs - m_lastMs;
+        m_lastMs = nowMs;
+
+        if(elapsed < m_remainingMs) {
+            m_level += (int64_t)elapsed * m_rate;
+            m_remainingMs -= elapsed;
+            return false;
+        }
+
+        set(m_target);
+        return true;
+    }
+
+    /**
+     * @brief active - Get whether a fade is in progress
+     * @return
+     */
+    bool active() const
+    {
+        return m_remainingMs > 0;
+    }
+
+    /**
+     * @brief remainingMs - Get the time left of the fade
+     * @return 0 when not fading
+     */
+    uint32_t remainingMs() const
+    {
+        return m_remainingMs;
+    }
+
+    uint8_t target() const
+    {
+        return m_target;
+    }
+
+    /**
+     * @brief level - Get the level rounded down
+     * @return
+     */
+    uint8_t level() const
+    {
+        return m_level >> Shift;
+    }
+
+    /**
+     * @brief dithered - Get the level for a frame, rounded up on the share of frames given by its
+     * fraction
+     * @param frame - Frame number, counting up each frame shown
+     * @return
+     */
+    uint8_t dithered(uint8_t frame) const
+    {
+        uint8_t whole = m_level >> Shift;
+        uint8_t fraction = m_level >> (Shift - 8);
+
+        // Bit reversed frame numbers visit every threshold once in 256 frames, evenly spread
+        uint8_t threshold = frame;
+        threshold = (threshold & 0xF0) >> 4 | (threshold & 0x0F) << 4;
+        threshold = (threshold & 0xCC) >> 2 | (threshold & 0x33) << 2;
+        threshold = (threshold & 0xAA) >> 1 | (threshold & 0x55) << 1;
+
+        return fraction > threshold && whole < 255 ? whole + 1 : whole;
+    }
+
+};
+
+#endif // FADE_H
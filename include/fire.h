@@ -18,6 +18,7 @@
 #include <FastLED.h>
 
 #include "ledgfx.h"
+#include "blur.h"
 
 class FireEffect
 {
@@ -41,6 +42,12 @@ class FireEffect
     static const byte BlendNeighbor3 = 1;
     static const byte BlendTotal = (BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3);
 
+    // Average steady state heat at the sparks, and the cells it takes to die out when Step() cools
+    // each cell by 0 or 1
+
+    static const int WarmBaseHeat = 110;
+    static const int WarmFlameLength = 160;
+
   public:
 
     FireEffect(int size, int cooling = 20, uint sparking = 100, int sparks = 3, int sparkHeight = 4, bool breversed = true, bool bmirrored = true)
@@ -63,7 +70,69 @@ class FireEffect
         delete [] heat;
     }
 
-    virtual void DrawFire(PixelOrder order = Sequential)
+    // StateSize
+    //
+    // Number of bytes SaveState() needs; the heat of every simulated cell
+
+    size_t StateSize() const
+    {
+        return Size;
+    }
+
+    // SaveState
+    //
+    // Copies the heat cells into buffer so the flame can be resumed later.  Returns the number of
+    // bytes written, or 0 if the buffer is too small.
+
+    size_t SaveState(uint8_t * buffer, size_t len) const
+    {
+        if (len < StateSize())
+            return 0;
+
+        memcpy(buffer, heat, Size);
+        return Size;
+    }
+
+    // LoadState
+    //
+    // Restores heat cells saved by SaveState().  Fails if the state was saved for a different size.
+
+    bool LoadState(const uint8_t * buffer, size_t len)
+    {
+        if (len != StateSize())
+            return false;
+
+        memcpy(heat, buffer, Size);
+        return true;
+    }
+
+    // WarmStart
+    //
+    // Seeds the heat with the flame's average steady state profile and runs the simulation for a
+    // few frames without drawing, so the flame starts out burning instead of building up from cold.
+    // At its steady state the heat falls about linearly from the sparks, over fewer cells the
+    // harder Step() cools each one.  WarmBaseHeat and WarmFlameLength were measured with a host
+    // run of Step() over strip lengths from 16 to 1200.
+
+    void WarmStart(int frames)
+    {
+        const int length = WarmFlameLength * 2 / ((Cooling * 10) / Size + 2);
+
+        for (int d = 0; d < Size; d++)
+        {
+            int h = d < length ? WarmBaseHeat * (length - d) / length : 0;
+            heat[Size - 1 - d] = min(255L, h - random(h / 4 + 1) + random(h / 4 + 1));
+        }
+
+        for (int i = 0; i < frames; i++)
+            Step();
+    }
+
+    // Step
+    //
+    // Advances the heat simulation by one frame
+
+    virtual void Step()
     {
         random16_add_entropy( random() );
 
@@ -72,12 +141,8 @@ class FireEffect
             heat[i] = max(0L, heat[i] - random(0, ((Cooling * 10) / Size) + 2));
 
         // Next drift heat up and diffuse it a little bit
-        for (int i = 0; i < Size; i++)
-            heat[i] = (heat[i] * BlendSelf +
-                       heat[(i + 1) % Size] * BlendNeighbor1 +
-                       heat[(i + 2) % Size] * BlendNeighbor2 +
-                       heat[(i + 3) % Size] * BlendNeighbor3)
-                      / BlendTotal;
+        const byte weights[] = { BlendSelf, BlendNeighbor1, BlendNeighbor2, BlendNeighbor3 };
+        kernel_advect8_down<4>(heat, Size, 1, weights, BlendTotal, true);
 
         // Randomly ignite new sparks down in the flame kernel
 
@@ -89,6 +154,11 @@ class FireEffect
                 heat[y] = heat[y] + random(160, 255);       // Can roll over which actually looks good!
             }
         }
+    }
+
+    virtual void DrawFire(PixelOrder order = Sequential)
+    {
+        Step();
 
         // Finally, convert heat to a color
 
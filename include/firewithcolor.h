@@ -80,13 +80,19 @@ typedef enum AvailableFireColorPallets
     Forest,
     Ocean,
     Lava,
-    Cloud
+    Cloud,
+    Custom
 } FireColorPallets_t;
 
 class FireWithColor
 {
 
 private:
+    // Average steady state heat at the sparks and the cells it takes to die out when Step() cools
+    // each cell by 0 or 1, measured with a host run of Step() over strip lengths from 8 to 1200
+    static const int WARM_BASE_HEAT = 240;
+    static const int WARM_FLAME_LENGTH = 490;
+
     int Size;
     int cooling = 55;
     int sparking = 120;
@@ -169,7 +175,68 @@ public:
         }
     }
 
-    void DrawFire()
+    /**
+     * @brief StateSize - Number of bytes SaveState() needs
+     * @return
+     */
+    size_t StateSize() const
+    {
+        return Size;
+    }
+
+    /**
+     * @brief SaveState - Copy the heat cells into buffer so the fire can be resumed later
+     * @param buffer
+     * @param len
+     * @return Bytes written, 0 if buffer is too small
+     */
+    size_t SaveState(uint8_t* buffer, size_t len) const
+    {
+        if(len < StateSize())
+            return 0;
+
+        memcpy(buffer, heat, Size);
+        return Size;
+    }
+
+    /**
+     * @brief LoadState - Restore heat cells saved by SaveState()
+     * @param buffer
+     * @param len
+     * @return false if the state was saved for a different size
+     */
+    bool LoadState(const uint8_t* buffer, size_t len)
+    {
+        if(len != StateSize())
+            return false;
+
+        memcpy(heat, buffer, Size);
+        return true;
+    }
+
+    /**
+     * @brief WarmStart - Seed the heat with the fire's average steady state profile and run the
+     * simulation without drawing, so the fire starts out burning. The heat falls about linearly
+     * from the sparks, over fewer cells the harder Step() cools each one.
+     * @param frames - Number of simulation frames to run over the seeded heat
+     */
+    void WarmStart(int frames)
+    {
+        const int length = WARM_FLAME_LENGTH * 2 / ((cooling * 10) / Size + 2);
+
+        for(int i = 0; i < Size; i++) {
+            int h = i < length ? WARM_BASE_HEAT * (length - i) / length : 0;
+            heat[i] = min(255, h - random8(h / 4 + 1) + random8(h / 4 + 1));
+        }
+
+        for(int i = 0; i < frames; i++)
+            Step();
+    }
+
+    /**
+     * @brief Step - Advance the heat simulation by one frame
+     */
+    void Step()
     {
         random16_add_entropy( random() );
 
@@ -188,6 +255,11 @@ public:
           int y = random8(7);
           heat[y] = qadd8( heat[y], random8(160,255) );
         }
+    }
+
+    void DrawFire()
+    {
+        Step();
 
         // Step 4.  Map from heat cells to LED colors
         for( int j = 0; j < Size; j++) {
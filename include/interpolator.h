@@ -0,0 +1,210 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef INTERPOLATOR_H
+#define INTERPOLATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define INTERPOLATE_OFF             0x00            // Show frames as they are presented
+#define INTERPOLATE_LINEAR          0x01            // Blend the RGB values
+#define INTERPOLATE_PERCEPTUAL      0x02            // Blend in a gamma 2 space, closer to perceived brightness
+#define INTERPOLATE_MODES           3
+
+#define INTERPOLATE_MAX_SEGMENT_MS  1000            // Longest blend between two frames
+
+
+/* *
+ * FrameInterpolator - Blends between streamed frames so a strip can be rendered at its full frame
+ * rate from frames sent at a much lower rate.
+ *
+ * Each presented frame starts a new segment blending from the frame being shown, which may itself
+ * be part way through a blend, to the presented frame. The segment lasts as long as the gap
+ * between the presented frame's timestamp and the previous one, or the gap between their arrival
+ * when the host doesn't send timestamps, so a frame is reached about when the next one arrives.
+ * Starting from the frame being shown rather than the previous target means a late or early frame
+ * changes the direction of the motion without a jump.
+ *
+ * Blending is an 8bit fixed point lerp per channel. In INTERPOLATE_PERCEPTUAL mode the lerp is
+ * between the square roots of the channel values, through a lookup table, and the result squared
+ * back, so the blend is even in perceived brightness instead of lingering on the bright end. The
+ * end of a segment is always the presented frame exactly.
+ * */
+template<uint16_t MaxPixels>
+class FrameInterpolator
+{
+
+private:
+    uint8_t m_from[MaxPixels * 3];              // Segment start
+    uint8_t m_to[MaxPixels * 3];                // Segment end
+    uint8_t m_sqrt[256];                        // Linear to gamma 2 space
+    uint8_t m_mode;                             // INTERPOLATE_*
+    uint16_t m_count;                           // Pixels in the segment
+    uint32_t m_startMs;                         // Segment start time
+    uint32_t m_durationMs;                      // Segment length, 0 shows m_to
+    uint32_t m_lastPresentMs;                   // Arrival of the previous frame
+    uint32_t m_lastTimestampMs;                 // Timestamp of the previous frame
+    bool m_hasTimestamp;                        // m_lastTimestampMs is set
+    bool m_active;                              // A frame has been presented
+
+    /**
+     * @brief lerp - 8bit fixed point lerp
+     * @param a
+     * @param b
+     * @param frac - 0 is a, 256 is b
+     * @return
+     */
+    static uint8_t lerp(uint8_t a, uint8_t b, uint16_t frac)
+    {
+        return b >= a ? a + (((b - a) * frac) >> 8) : a - (((a - b) * frac) >> 8);
+    }
+
+    /**
+     * @brief square - Gamma 2 space back to linear, rounded so 255 maps to 255
+     * @param v
+     * @return
+     */
+    static uint8_t square(uint8_t v)
+    {
+        return (v * v + 127) / 255;
+    }
+
+public:
+
+    FrameInterpolator() :
+        m_mode(INTERPOLATE_OFF),
+        m_count(0),
+        m_startMs(0),
+        m_durationMs(0),
+        m_lastPresentMs(0),
+        m_lastTimestampMs(0),
+        m_hasTimestamp(false),
+        m_active(false)
+    {
+        // Integer square root scaled to 0-255
+        uint16_t r = 0;
+        for(uint16_t v = 0; v < 256; v++) {
+            while((uint32_t)(r + 1) * (r + 1) <= (uint32_t)v * 255) r++;
+            m_sqrt[v] = r;
+        }
+    }
+
+    /**
+     * @brief setMode - Sets the blend mode and starts over from the next presented frame
+     * @param mode - INTERPOLATE_*
+     */
+    void setMode(uint8_t mode)
+    {
+        m_mode = mode < INTERPOLATE_MODES ? mode : INTERPOLATE_OFF;
+        reset();
+    }
+
+    uint8_t mode() const
+    {
+        return m_mode;
+    }
+
+    /**
+     * @brief reset - Forgets the presented frames, the next one is shown without a blend
+     */
+    void reset()
+    {
+        m_active = false;
+        m_hasTimestamp = false;
+    }
+
+    /**
+     * @brief present - Starts a segment to a newly presented frame
+     * @param current - RGB frame being shown, 3 bytes per pixel
+     * @param next - RGB frame presented
+     * @param count - Number of pixels, at most MaxPixels
+     * @param nowMs - Current time
+     * @param hasTimestamp - timestampMs is set
+     * @param timestampMs - Host time of the frame
+     */
+    void present(const uint8_t* current, const uint8_t* next, uint16_t count, uint32_t nowMs,
+                 bool hasTimestamp, uint32_t timestampMs)
+    {
+        if(count > MaxPixels) count = MaxPixels;
+
+        uint32_t duration = 0;
+
+        if(m_active && count == m_count) {
+
+            if(hasTimestamp && m_hasTimestamp) duration = timestampMs - m_lastTimestampMs;
+            else duration = nowMs - m_lastPresentMs;
+
+            if(duration > INTERPOLATE_MAX_SEGMENT_MS) duration = 0;
+        }
+
+        memcpy(m_from, current, count * 3);
+        memcpy(m_to, next, count * 3);
+
+        m_count = count;
+        m_startMs = nowMs;
+        m_durationMs = duration;
+        m_lastPresentMs = nowMs;
+        m_lastTimestampMs = timestampMs;
+        m_hasTimestamp = hasTimestamp;
+        m_active = true;
+    }
+
+    /**
+     * @brief render - Renders the blend at a point in time
+     * @param out - RGB frame buffer, 3 bytes per pixel
+     * @param count - Number of pixels in the frame buffer. Pixels past the segment are not written.
+     * @param nowMs - Current time
+     * @return false when no frame has been presented and nothing was written
+     */
+    bool render(uint8_t* out, uint16_t count, uint32_t nowMs) const
+    {
+        if(!m_active) return false;
+
+        if(count > m_count) count = m_count;
+
+        uint32_t elapsed = nowMs - m_startMs;
+        uint16_t frac = elapsed >= m_durationMs ? 256 : (elapsed << 8) / m_durationMs;
+
+        if(frac == 256) {
+            memcpy(out, m_to, count * 3);
+        } else if(m_mode == INTERPOLATE_PERCEPTUAL) {
+            for(uint32_t i = 0; i < count * 3u; i++) out[i] = square(lerp(m_sqrt[m_from[i]], m_sqrt[m_to[i]], frac));
+        } else {
+            for(uint32_t i = 0; i < count * 3u; i++) out[i] = lerp(m_from[i], m_to[i], frac);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief blending - Get whether a segment is still in progress
+     * @param nowMs - Current time
+     * @return
+     */
+    bool blending(uint32_t nowMs) const
+    {
+        return m_active && nowMs - m_startMs < m_durationMs;
+    }
+
+};
+
+#endif // INTERPOLATOR_H
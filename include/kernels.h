@@ -0,0 +1,284 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* *
+ * Whole buffer kernels for packed RGB frame buffers, a CRGB array cast to bytes.
+ *
+ * Every kernel treats the buffer as plain bytes and works on 4 of them at a time in a 32bit word,
+ * so the 3 byte pixels don't need to line up with words. The ends of the buffer that aren't word
+ * aligned are done a byte at a time. Results match FastLED's per pixel functions exactly:
+ *      kernel_scale8       - CRGB::nscale8(), scale8() per channel
+ *      kernel_fade8        - CRGB::fadeToBlackBy()
+ *      kernel_qadd8        - CRGB::operator+=(), qadd8() per channel
+ *      kernel_fill_rgb     - fill_solid()
+ *      kernel_fill_hue     - CRGB::setHue() on every pixel
+ *      kernel_fill_hue_gradient - CRGB::setHue() with the hue stepping by a fixed amount per pixel
+ *
+ * Scaling has no 8bit multiply to use on the Cortex-M4, so it multiplies the even and odd bytes of
+ * a word as two pairs of 16bit lanes. A lane holds at most 255 * 256 so it never carries into the
+ * next one. With the M4's DSP extension UXTB16 does the lane packing and UQADD8 the saturating add;
+ * elsewhere the lanes are masked out and the saturating add detects the carry out of each byte
+ * and saturates it with a mask.
+ *
+ * The hue kernels convert each distinct hue once. A fixed step through the 256 hues repeats every
+ * 256 / (largest power of 2 dividing the step) pixels, so a gradient converts at most one period and
+ * copies it down the rest of the strip. Conversion uses the structure of FastLED's rainbow map at
+ * full saturation and value: 8 sections of 32 hues, each channel in a section a constant plus or
+ * minus a third or two thirds of the position in it, skipping hsv2rgb_rainbow()'s saturation and
+ * value scaling.
+ * */
+
+/**
+ * @brief kernel_load - Loads a word from a byte buffer, a single load instruction
+ */
+inline uint32_t kernel_load(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    return w;
+}
+
+/**
+ * @brief kernel_store - Stores a word to a byte buffer, a single store instruction
+ */
+inline void kernel_store(uint8_t* p, uint32_t w) {
+    memcpy(p, &w, 4);
+}
+
+/**
+ * @brief kernel_head - Number of bytes before a pointer is word aligned
+ * @param p
+ * @param len - Length of the buffer, the result is at most len
+ * @return
+ */
+inline size_t kernel_head(const uint8_t* p, size_t len) {
+    size_t head = (4 - ((uintptr_t)p & 3)) & 3;
+    return head < len ? head : len;
+}
+
+/**
+ * @brief kernel_scale8_word - scale8() on each byte of a word
+ * @param w
+ * @param scale - scale8() scale + 1, 1 to 256
+ * @return
+ */
+inline uint32_t kernel_scale8_word(uint32_t w, uint32_t scale) {
+#if defined(__ARM_FEATURE_SIMD32)
+    // UXTB16 splits the bytes into lanes, and with a rotate takes the high byte of each product
+    uint32_t even, odd;
+    asm("uxtb16 %0, %1" : "=r" (even) : "r" (w));
+    asm("uxtb16 %0, %1, ror #8" : "=r" (odd) : "r" (w));
+    even *= scale;
+    odd *= scale;
+    asm("uxtb16 %0, %1, ror #8" : "=r" (even) : "r" (even));
+    return even | (odd & 0xFF00FF00);
+#else
+    uint32_t even = (((w & 0x00FF00FF) * scale) >> 8) & 0x00FF00FF;
+    uint32_t odd = (((w >> 8) & 0x00FF00FF) * scale) & 0xFF00FF00;
+    return even | odd;
+#endif
+}
+
+/**
+ * @brief kernel_scale8 - Scales every byte by scale/256, the same as nscale8() on every pixel
+ * @param data - Pixels as bytes
+ * @param len - Number of bytes
+ * @param scale
+ */
+inline void kernel_scale8(uint8_t* data, size_t len, uint8_t scale) {
+
+    const uint32_t s = (uint32_t)scale + 1;
+    size_t head = kernel_head(data, len);
+    size_t i = 0;
+
+    for(; i < head; i++) data[i] = (data[i] * s) >> 8;
+
+    for(; i + 4 <= len; i += 4) kernel_store(&data[i], kernel_scale8_word(kernel_load(&data[i]), s));
+
+    for(; i < len; i++) data[i] = (data[i] * s) >> 8;
+}
+
+/**
+ * @brief kernel_fade8 - Fades every byte towards black, the same as fadeToBlackBy() on every pixel
+ * @param data - Pixels as bytes
+ * @param len - Number of bytes
+ * @param fade - Amount to fade, 255 is black
+ */
+inline void kernel_fade8(uint8_t* data, size_t len, uint8_t fade) {
+    kernel_scale8(data, len, 255 - fade);
+}
+
+/**
+ * @brief kernel_qadd8_word - qadd8() on each byte of a word
+ * @param a
+ * @param b
+ * @return
+ */
+inline uint32_t kernel_qadd8_word(uint32_t a, uint32_t b) {
+#if defined(__ARM_FEATURE_SIMD32)
+    uint32_t r;
+    asm("uqadd8 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+#else
+    // Add the low 7 bits of each byte, then put the top bits back in without carrying
+    uint32_t sum = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+    // A byte carried out when both top bits were set, or either was and the sum's top bit isn't
+    uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+    return sum | ((carry >> 7) * 0xFF);
+#endif
+}
+
+/**
+ * @brief kernel_qadd8 - Adds src to dst with each byte saturating at 255, the same as += on
+ * every pixel
+ * @param dst - Pixels as bytes
+ * @param src - Pixels as bytes
+ * @param len - Number of bytes
+ */
+inline void kernel_qadd8(uint8_t* dst, const uint8_t* src, size_t len) {
+
+    size_t head = kernel_head(dst, len);
+    size_t i = 0;
+
+    for(; i < head; i++) dst[i] = dst[i] + src[i] > 255 ? 255 : dst[i] + src[i];
+
+    // src may not be aligned the same as dst, memcpy loads handle that
+    for(; i + 4 <= len; i += 4) {
+        uint32_t s;
+        memcpy(&s, &src[i], 4);
+        kernel_store(&dst[i], kernel_qadd8_word(kernel_load(&dst[i]), s));
+    }
+
+    for(; i < len; i++) dst[i] = dst[i] + src[i] > 255 ? 255 : dst[i] + src[i];
+}
+
+/**
+ * @brief kernel_fill_rgb - Sets every pixel to one color
+ * @param data - Pixels as bytes
+ * @param count - Number of pixels
+ * @param r
+ * @param g
+ * @param b
+ */
+inline void kernel_fill_rgb(uint8_t* data, size_t count, uint8_t r, uint8_t g, uint8_t b) {
+
+    const uint8_t color[3] = { r, g, b };
+    const size_t len = count * 3;
+    size_t head = kernel_head(data, len);
+    size_t i = 0;
+
+    for(; i < head; i++) data[i] = color[i % 3];
+
+    // 4 pixels are 3 words, built for the channel the first aligned byte falls on
+    uint8_t pattern[12];
+    for(size_t k = 0; k < 12; k++) pattern[k] = color[(i + k) % 3];
+
+    const uint32_t w0 = kernel_load(&pattern[0]);
+    const uint32_t w1 = kernel_load(&pattern[4]);
+    const uint32_t w2 = kernel_load(&pattern[8]);
+
+    for(; i + 12 <= len; i += 12) {
+        kernel_store(&data[i], w0);
+        kernel_store(&data[i + 4], w1);
+        kernel_store(&data[i + 8], w2);
+    }
+
+    for(; i < len; i++) data[i] = color[i % 3];
+}
+
+/**
+ * @brief kernel_hue_rgb - Converts a hue at full saturation and value to RGB, the same as
+ * hsv2rgb_rainbow()
+ * @param hue
+ * @param rgb - 3 bytes
+ */
+inline void kernel_hue_rgb(uint8_t hue, uint8_t* rgb) {
+
+    // scale8() of the position in the section, 0-248, by 1/3 and 2/3
+    const uint32_t offset8 = (hue & 0x1F) << 3;
+    const uint8_t third = (offset8 * 86) >> 8;
+    const uint8_t twothirds = (offset8 * 171) >> 8;
+
+    uint8_t r, g, b;
+
+    switch(hue >> 5) {
+    case 0:  r = 255 - third;        g = third;              b = 0;                  break;  // Red to orange
+    case 1:  r = 171;                g = 85 + third;         b = 0;                  break;  // Orange to yellow
+    case 2:  r = 171 - twothirds;    g = 170 + third;        b = 0;                  break;  // Yellow to green
+    case 3:  r = 0;                  g = 255 - third;        b = third;              break;  // Green to aqua
+    case 4:  r = 0;                  g = 171 - twothirds;    b = 85 + twothirds;     break;  // Aqua to blue
+    case 5:  r = third;              g = 0;                  b = 255 - third;        break;  // Blue to purple
+    case 6:  r = 85 + third;         g = 0;                  b = 171 - third;        break;  // Purple to pink
+    default: r = 170 + third;        g = 0;                  b = 85 - third;         break;  // Pink to red
+    }
+
+    rgb[0] = r;
+    rgb[1] = g;
+    rgb[2] = b;
+}
+
+/**
+ * @brief kernel_fill_hue - Sets every pixel to one hue at full saturation and value
+ * @param data - Pixels as bytes
+ * @param count - Number of pixels
+ * @param hue
+ */
+inline void kernel_fill_hue(uint8_t* data, size_t count, uint8_t hue) {
+    uint8_t rgb[3];
+    kernel_hue_rgb(hue, rgb);
+    kernel_fill_rgb(data, count, rgb[0], rgb[1], rgb[2]);
+}
+
+/**
+ * @brief kernel_fill_hue_gradient - Sets the pixels to a rainbow with the hue stepping by a fixed
+ * amount per pixel, the same as fill_rainbow()
+ * @param data - Pixels as bytes
+ * @param count - Number of pixels
+ * @param hue - Hue of the first pixel
+ * @param step - Added to the hue for each pixel
+ */
+inline void kernel_fill_hue_gradient(uint8_t* data, size_t count, uint8_t hue, uint8_t step) {
+
+    if(step == 0) {
+        kernel_fill_hue(data, count, hue);
+        return;
+    }
+
+    // The hues repeat after 256 / (lowest set bit of the step) pixels
+    size_t period = 256 / (step & -step);
+    size_t done = period < count ? period : count;
+
+    for(size_t i = 0; i < done; i++, hue += step) kernel_hue_rgb(hue, &data[i * 3]);
+
+    // Copy what's done after itself, always a whole number of periods
+    while(done < count) {
+        size_t n = done < count - done ? done : count - done;
+        memcpy(&data[done * 3], data, n * 3);
+        done += n;
+    }
+}
+
+#endif // KERNELS_H
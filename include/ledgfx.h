@@ -10,6 +10,7 @@
 //
 // History:     OCt-18-2020     davepl      Created from main.cpp code
 //              April-02-2021   tomkjr      Added USE_SYS_TIME ifdef
+//                                          Added freezable effect clock
 //---------------------------------------------------------------------------
 
 #ifndef LEDGFX_H
@@ -18,6 +19,7 @@
 #include <Arduino.h>
 #define FASTLED_INTERNAL
 #include <FastLED.h>
+#include "config.h"
 
 #ifdef USE_SYS_TIME
 #include <sys/time.h>                   // For time-of-day
@@ -45,6 +47,8 @@ enum PixelOrder
   RightLeft   = 16
 };
 
+#if FEATURE_FAN_HELPERS
+
 DEFINE_GRADIENT_PALETTE( vu_gpGreen ) 
 {
       0,     0,   4,   0,   // near black green
@@ -111,6 +115,8 @@ int GetFanPixelOrder(int iPos, PixelOrder order = Sequential)
   }
 }
 
+#endif // FEATURE_FAN_HELPERS
+
 
 inline float RandomFloat()
 {
@@ -118,20 +124,83 @@ inline float RandomFloat()
     return r;
 }
 
+// Effect clock
+//
+// Time base effects animate against.  It normally follows elapsedTimeMs, or the time of day with
+// USE_SYS_TIME, but can be frozen and then stepped by a fixed amount per frame, so a frame can be
+// reproduced or profiled on its own.
+
+inline uint32_t EffectClockSourceMs()
+{
+#ifdef USE_SYS_TIME
+    timeval tv = { 0, 0 };
+    gettimeofday(&tv, nullptr);
+    return (uint32_t)((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+#else
+    return (uint32_t)elapsedTimeMs;
+#endif
+}
+
+static bool     effectClockFrozen = false;  // Clock is frozen and only moves with StepEffectClock()
+static uint32_t effectClockFrozenMs = 0;    // Clock time while frozen
+static uint32_t effectClockOffsetMs = 0;    // Time spent frozen, subtracted from the source while running
+
+inline uint32_t EffectClockMs()
+{
+    return effectClockFrozen ? effectClockFrozenMs : EffectClockSourceMs() - effectClockOffsetMs;
+}
+
+inline bool EffectClockFrozen()
+{
+    return effectClockFrozen;
+}
+
+// FreezeEffectClock
+//
+// Stops (true) or restarts (false) the effect clock.  Restarting continues from the frozen time.
+
+inline void FreezeEffectClock(bool freeze)
+{
+    if (freeze == effectClockFrozen)
+        return;
+
+    if (freeze)
+        effectClockFrozenMs = EffectClockMs();
+    else
+        effectClockOffsetMs = EffectClockSourceMs() - effectClockFrozenMs;
+
+    effectClockFrozen = freeze;
+}
+
+// StepEffectClock
+//
+// Advances a frozen effect clock by a virtual time step
+
+inline void StepEffectClock(uint32_t ms)
+{
+    if (effectClockFrozen)
+        effectClockFrozenMs += ms;
+}
+
+// UnixTime
+//
+// Effect clock in seconds.  With USE_SYS_TIME it is the time of day less the time spent frozen.
+
 inline double UnixTime()
 {
 
 #ifdef USE_SYS_TIME
 
-    timeval tv = { 0 };
+    timeval tv = { 0, 0 };
     gettimeofday(&tv, nullptr);
-    return (double)(tv.tv_usec / 1000000.0 + (double) tv.tv_sec);
+    uint32_t frozenMs = EffectClockSourceMs() - EffectClockMs();
+    return (double)(tv.tv_usec / 1000000.0 + (double) tv.tv_sec) - frozenMs / 1000.0;
 
 #else
 
     // This is not exactly the same as using sys/time.h
     // Just trying to hack a work around for building on Teensy
-    return (double)(elapsedTimeMs / 1000.0);
+    return (double)(EffectClockMs() / 1000.0);
 
 #endif
 
@@ -148,6 +217,8 @@ CRGB ColorFraction(CRGB colorIn, float fraction)
   return CRGB(colorIn).fadeToBlackBy(255 * (1.0f - fraction));
 }
 
+#if FEATURE_FAN_HELPERS
+
 // DrawFanPixels
 //
 // Just like DrawPixels but draws logically into a fan bank in a direction such as top down rather than
@@ -188,6 +259,8 @@ void DrawFanPixels(float fPos, float count, CRGB color, PixelOrder order = Seque
   }
 }
 
+#endif // FEATURE_FAN_HELPERS
+
 // DrawPixels
 // 
 // Uses floating point math to draw a floating point number of pixels starting at a 
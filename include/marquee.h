@@ -19,6 +19,8 @@
 #define FASTLED_INTERNAL
 #include <FastLED.h>
 
+#include "kernels.h"
+
 
 void DrawMarquee()
 {
@@ -26,11 +28,7 @@ void DrawMarquee()
     j+=4;
     byte k = j;
 
-    // Roughly equivalent to fill_rainbow(g_LEDs, NUM_LEDS, j, 8);
-
-    CRGB c;
-    for (int i = 0; i < FastLED.count(); i ++)
-        FastLED.leds()[i] = c.setHue(k+=8);
+    kernel_fill_hue_gradient((uint8_t *)FastLED.leds(), FastLED.count(), k + 8, 8);
 
     static int scroll = 0;
     scroll++;
@@ -48,15 +46,10 @@ void DrawMarqueeMirrored()
     j+=4;
     byte k = j;
 
-    // Roughly equivalent to fill_rainbow(g_LEDs, NUM_LEDS, j, 8);
-
-    CRGB c;
-    for (int i = 0; i < (FastLED.count() + 1) / 2; i ++)
-    {
-        FastLED.leds()[i] = c.setHue(k);
-        FastLED.leds()[FastLED.count() - 1 - i] = c.setHue(k);
-        k+= 8;
-    }
+    // Rainbow the first half, then mirror it onto the second
+    kernel_fill_hue_gradient((uint8_t *)FastLED.leds(), (FastLED.count() + 1) / 2, k, 8);
+    for (int i = 0; i < FastLED.count() / 2; i ++)
+        FastLED.leds()[FastLED.count() - 1 - i] = FastLED.leds()[i];
 
 
     static int scroll = 0;
@@ -26,9 +26,10 @@
 
 /* *
  * Input Packet structure
- * [CMD:param_1:param_2:param_3:param_4]\r
+ * [CMD:param_1:param_2:...:param_n]\r
  *
- * Parameters are optional and command dependant
+ * Parameters are optional and command dependant. The number of parameters is only limited by
+ * the packet length and the max set for each command in its command table entry.
  *
  * */
 
@@ -41,12 +42,14 @@
  *
  * */
 
-#define MAX_PROTO_PACKET_LEN                256             // Max length of a packet
+#define MAX_PROTO_PACKET_LEN                512             // Max length of a packet
 #define MAX_PROTO_CMD                       10              // Max length of a command
-#define MAX_PROTO_PARAM_COUNT               4               // Max number of parameters for any one command packet
+#define MAX_PROTO_ARGS                      32              // Max number of parameters for any one command packet
+#define MAX_PROTO_PARAM_COUNT               4               // Max number of parameters for any one response packet
 #define MAX_PROTO_PARAM_LEN                 50              // Max number of characters for any one parameter assuming there is only one param
 
 #define ERR_PROTO_SUCCESS                   0               // Code for success no error.
+#define ERR_PROTO_COALESCED                 1               // Not an error. Command superseded by a newer command of the same kind before it was applied.
 
 #define ERR_PROTO_CMD_PARSING               -100            // Generic command processing error
 #define ERR_PROTO_CP_MISSING_STX            -101            // Missing expected STX character
@@ -60,6 +63,8 @@
 #define ERR_PROTO_CP_PARAM_OUT_RANGE        -109            // Parameter out of range
 #define ERR_PROTO_CP_CRC16_MISMATCH         -110            // CRC16 mismatch
 #define ERR_PROTO_CP_MISSING_CRC16          -111            // CRC16 missing
+#define ERR_PROTO_CP_PARAM_INVALID          -112            // Parameter is not a valid value for its type
+#define ERR_PROTO_CP_TOO_MANY_PARAMS        -113            // More parameters than the command accepts
 
 #define ERR_PROTO_RSP_BUILDING              -200            // Response packet error
 #define ERR_PROTO_RB_TOO_MANY_PARAMS        -201            // Too many params attempted in response packet
@@ -78,9 +83,27 @@
 #define  PROTO_CR                           '\r'            // Cairrage Return Char
 #define  PROTO_NL                           '\n'            // NewLine Char
 
+#define PROTO_FRAME_LINE                    1               // proto_frame_char() completed a line
+
 #define DISABLE_CRC16                        1              // Disable checking for CRC16
 
+#ifndef PROTO_CRC16_TABLE
+#define PROTO_CRC16_TABLE                   1               // Table driven CRC16, 0 works it out a bit at a time without the 512 byte table
+#endif
+
+/* *
+ * Command parameter types. A command's parameter spec is a string with one of these characters per
+ * parameter, in order.
+ * */
+#define PROTO_ARG_HEX8                      'B'             // 8bit value in HEX
+#define PROTO_ARG_HEX16                     'W'             // 16bit value in HEX
+#define PROTO_ARG_HEX32                     'L'             // 32bit value in HEX
+#define PROTO_ARG_COLOR                     'C'             // 24bit RGB color code in HEX
+#define PROTO_ARG_DEC                       'D'             // 32bit value in decimal
+#define PROTO_ARG_RAW                       'S'             // Unparsed slice of the receive buffer
+
 
+#if PROTO_CRC16_TABLE
 const unsigned short CRC16_table[256] = {
     0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
     0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
@@ -115,17 +138,98 @@ const unsigned short CRC16_table[256] = {
     0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
+#endif
 
 
 
+/* *
+ * Slice of a receive buffer
+ * */
+typedef struct slice_struct
+{
+    uint16_t offset;                                            // Offset of the first character in the buffer
+    uint16_t len;                                               // Number of characters
+} proto_slice_t;
+
+/* *
+ * Received packet. The command and params are slices into the receive buffer the packet was
+ * parsed from and are only valid until that buffer is reused. Individual params are read with
+ * proto_next_param().
+ * */
 typedef struct packet_struct
 {
-    char cmd[MAX_PROTO_CMD];                                    // Command parsed from packet buffer
-    char params[MAX_PROTO_PARAM_COUNT][MAX_PROTO_PARAM_LEN];    // Array of params parsed from packet buffer
-    uint8_t param_count;                                        // Number of params in proto_params
+    const char* buffer;                                         // Receive buffer the packet was parsed from
+    proto_slice_t cmd;                                          // Command slice
+    proto_slice_t params;                                       // Slice of all params and their separators
+    uint16_t param_count;                                       // Number of params in params
     uint16_t crc16;                                             // CRC16 calculated for protocol packet data
 } proto_pkt_t;
 
+/* *
+ * Response packet built by a command handler
+ * */
+typedef struct response_packet_struct
+{
+    char cmd[MAX_PROTO_CMD];                                    // Command the response is for
+    char params[MAX_PROTO_PARAM_COUNT][MAX_PROTO_PARAM_LEN];    // Array of response params
+    uint8_t param_count;                                        // Number of params in proto_params
+    const char* payload;                                        // Optional bulk param printed after params, not copied
+    uint16_t payload_len;                                       // Length of payload
+    int16_t error_code;                                         // Error code in params[0]
+    uint16_t crc16;                                             // CRC16 calculated for protocol packet data
+} proto_rsp_t;
+
+/* *
+ * Input framer. Gathers received characters into lines for proto_parse_pkt_buffer() and
+ * resynchronizes on the next STX after noise, a lost CR or an overflow. STX is never inside a
+ * packet, so one always starts a new packet, and characters outside a packet are skipped rather
+ * than buffered. At most one buffer of characters is thrown away for any glitch and a packet that
+ * follows one is kept.
+ * */
+typedef struct framer_struct
+{
+    char* buffer;                                               // Input buffer, a completed line starts at buffer[0]
+    uint16_t size;                                              // Input buffer size
+    uint16_t len;                                               // Characters of the packet being received
+    uint16_t line_len;                                          // Length of the completed line
+    uint16_t skipped;                                           // Characters skipped outside a packet since the last line
+    bool overflowed;                                            // Skipping the rest of a packet that overflowed
+    uint32_t wasted;                                            // Characters thrown away resynchronizing, wraps
+} proto_framer_t;
+
+/* *
+ * Parsed command parameter. The member read must match the parameter type, PROTO_ARG_RAW params
+ * are in slice and the rest are values.
+ * */
+typedef union arg_union
+{
+    uint8_t u8;                                                 // PROTO_ARG_HEX8
+    uint16_t u16;                                               // PROTO_ARG_HEX16
+    uint32_t u32;                                               // PROTO_ARG_HEX32, PROTO_ARG_COLOR, PROTO_ARG_DEC
+    proto_slice_t slice;                                        // PROTO_ARG_RAW
+} proto_arg_t;
+
+typedef struct command_struct proto_cmd_t;
+
+/* *
+ * Command handler. Receives the command table entry, the typed params and a response packet to
+ * build and print.
+ * */
+typedef void (*proto_cmd_handler_t)(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response);
+
+/* *
+ * Command table entry
+ * */
+struct command_struct
+{
+    const char* name;                                           // Command code
+    proto_cmd_handler_t handler;                                // Handler called with the typed params
+    const char* arg_spec;                                       // One PROTO_ARG_* character per param, the last one repeats for any further params
+    uint8_t min_args;                                           // Min number of params
+    uint8_t max_args;                                           // Max number of params, at most MAX_PROTO_ARGS
+    bool coalesce;                                              // Only the newest queued packet is applied. Not allowed with PROTO_ARG_RAW params.
+};
+
 
 
 
@@ -139,7 +243,15 @@ typedef struct packet_struct
  * */
 uint16_t crc16(uint16_t crc, uint8_t data)
 {
+#if PROTO_CRC16_TABLE
     return CRC16_table[((crc >> 8) ^ data) & 0xff] ^ (crc << 8);
+#else
+    // CRC-CCITT polynomial 0x1021, the table's second entry
+    crc ^= (uint16_t)data << 8;
+    for(uint8_t i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+#endif
 }
 /**
  * @brief crc16_buffer
@@ -175,6 +287,14 @@ uint16_t crc16_buffer(uint16_t crc, uint8_t* data, uint16_t start, uint16_t len)
  * @param pkt
  */
 void proto_clear_pkt(proto_pkt_t* pkt) {
+    memset(pkt, 0, sizeof(proto_pkt_t));
+}
+
+/**
+ * @brief proto_clear_pkt - Clears protocol response packet data structure
+ * @param pkt
+ */
+void proto_clear_pkt(proto_rsp_t* pkt) {
 
     //clear cmd buffer
     memset(pkt->cmd, 0, MAX_PROTO_CMD);
@@ -182,6 +302,9 @@ void proto_clear_pkt(proto_pkt_t* pkt) {
     //clear param buffers
     for(int i=0; i<MAX_PROTO_PARAM_COUNT; i++) memset(pkt->params[i], 0, MAX_PROTO_PARAM_LEN);
     pkt->param_count = 0x00;
+    pkt->payload = NULL;
+    pkt->payload_len = 0;
+    pkt->error_code = ERR_PROTO_SUCCESS;
     pkt->crc16 = 0x0000;
 }
 
@@ -197,7 +320,8 @@ int16_t proto_parse_pkt_buffer(char* buffer, uint16_t len, proto_pkt_t* pkt) {
     if(len <= 0) return 0;
 
     uint16_t pbi = 0, si = 0;
-    pkt->crc16 = 0;
+    proto_clear_pkt(pkt);
+    pkt->buffer = buffer;
 
     /* Searching for STX */
     while(buffer[pbi++] != PROTO_STX && pbi < len) { si++; };
@@ -207,14 +331,16 @@ int16_t proto_parse_pkt_buffer(char* buffer, uint16_t len, proto_pkt_t* pkt) {
     }
 
     int i=0;
+    pkt->cmd.offset = pbi;
     while(pbi < len
           && i < MAX_PROTO_CMD
           && buffer[pbi] != PROTO_PSC
           && buffer[pbi] != PROTO_ETX) {
-        pkt->cmd[i++] = buffer[pbi++];
+        i++;
+        pbi++;
     }
 
-    pkt->cmd[i] = 0x0;
+    pkt->cmd.len = i;
 
     //check for errors
     if(pbi >= len) {
@@ -225,26 +351,24 @@ int16_t proto_parse_pkt_buffer(char* buffer, uint16_t len, proto_pkt_t* pkt) {
         /* CMD with no Params */
     } else if(buffer[pbi] == PROTO_PSC) {
 
+        // Only count the params here, they are read in place by proto_next_param()
+        pkt->params.offset = pbi + 1;
+
         do
         {
             pbi++;
-            int pci = 0;
             while(pbi < len
-                  && pci < MAX_PROTO_PARAM_LEN
                   && buffer[pbi] != PROTO_PSC
                   && buffer[pbi] != PROTO_ETX) {
-
-                pkt->params[pkt->param_count][pci++] = buffer[pbi++];
-
+                pbi++;
             };
 
-            pkt->params[pkt->param_count][pci++] = 0x00;
             pkt->param_count++;
-            //print_line(PRINT_DEBUG_CHAR, pkt->params[pkt->param_count-1]);
 
         }while(pbi < len
-               && buffer[pbi] != PROTO_ETX
-               && pkt->param_count < MAX_PROTO_PARAM_COUNT);
+               && buffer[pbi] != PROTO_ETX);
+
+        pkt->params.len = pbi - pkt->params.offset;
     }
 
     //if on ETX char increment to next byte
@@ -280,13 +404,270 @@ int16_t proto_parse_pkt_buffer(char* buffer, uint16_t len, proto_pkt_t* pkt) {
     return pbi;
 }
 
+/**
+ * @brief proto_init_framer - Starts a framer on an input buffer
+ * @param framer
+ * @param buffer
+ * @param size
+ */
+void proto_init_framer(proto_framer_t* framer, char* buffer, uint16_t size) {
+    framer->buffer = buffer;
+    framer->size = size;
+    framer->len = 0;
+    framer->line_len = 0;
+    framer->skipped = 0;
+    framer->overflowed = false;
+    framer->wasted = 0;
+}
+
+/**
+ * @brief proto_frame_char - Adds a received character to a framer. A completed line is in the
+ * framer's buffer, line_len characters long and starting with STX, until the next call.
+ * @param framer
+ * @param ich - Received character
+ * @return PROTO_FRAME_LINE when a CR completed a line, 0 when there is no line yet or an error
+ * code when a packet or noise was thrown away: ERR_PROTO_CP_MISSING_EFC for a packet cut short
+ * by the next STX, ERR_PROTO_CP_CMD_OVERFLOW for a packet longer than the buffer and
+ * ERR_PROTO_CP_MISSING_STX for a line of noise.
+ */
+int16_t proto_frame_char(proto_framer_t* framer, char ich) {
+
+    if(ich == PROTO_NL) return 0;
+
+    if(ich == PROTO_CR) {
+
+        bool noise = framer->len == 0 && framer->skipped > 0 && !framer->overflowed;
+
+        framer->line_len = framer->len;
+        framer->len = 0;
+        framer->skipped = 0;
+        framer->overflowed = false;
+
+        if(framer->line_len > 0) return PROTO_FRAME_LINE;
+        return noise ? ERR_PROTO_CP_MISSING_STX : 0;
+    }
+
+    if(ich == PROTO_STX) {
+
+        // The packet being received lost its CR, the new one replaces it
+        int16_t error_code = framer->len > 0 ? ERR_PROTO_CP_MISSING_EFC : 0;
+
+        framer->wasted += framer->len;
+        framer->buffer[0] = ich;
+        framer->len = 1;
+        framer->skipped = 0;
+        framer->overflowed = false;
+        return error_code;
+    }
+
+    if(framer->len == 0) {
+        framer->skipped++;
+        framer->wasted++;
+        return 0;
+    }
+
+    if(framer->len >= framer->size) {
+        // Skip the rest of the packet up to the next STX or CR
+        framer->wasted += framer->len + 1;
+        framer->len = 0;
+        framer->overflowed = true;
+        return ERR_PROTO_CP_CMD_OVERFLOW;
+    }
+
+    framer->buffer[framer->len++] = ich;
+    return 0;
+}
+
+/**
+ * @brief proto_parse_hex - Parses a HEX number with an optional 0x prefix.
+ * @param str - Characters to parse
+ * @param len - Number of characters
+ * @param max - Max allowed value
+ * @param value - Parsed value
+ * @return ERR_PROTO_SUCCESS, ERR_PROTO_CP_PARAM_INVALID or ERR_PROTO_CP_PARAM_OUT_RANGE
+ */
+int16_t proto_parse_hex(const char* str, uint16_t len, uint32_t max, uint32_t* value) {
+
+    if(len >= 2 && str[0] == '0' && (str[1] | 0x20) == 'x') {
+        str += 2;
+        len -= 2;
+    }
+
+    if(len == 0) return ERR_PROTO_CP_PARAM_INVALID;
+
+    uint32_t v = 0;
+    for(uint16_t i=0; i<len; i++) {
+
+        uint8_t c = str[i];
+        uint8_t digit;
+
+        if(c >= '0' && c <= '9') digit = c - '0';
+        else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f') digit = (c | 0x20) - 'a' + 10;
+        else return ERR_PROTO_CP_PARAM_INVALID;
+
+        if(v > (max >> 4)) return ERR_PROTO_CP_PARAM_OUT_RANGE;
+        v = (v << 4) | digit;
+    }
+
+    if(v > max) return ERR_PROTO_CP_PARAM_OUT_RANGE;
+
+    *value = v;
+    return ERR_PROTO_SUCCESS;
+}
+
+/**
+ * @brief proto_parse_dec - Parses an unsigned decimal number.
+ * @param str - Characters to parse
+ * @param len - Number of characters
+ * @param max - Max allowed value
+ * @param value - Parsed value
+ * @return ERR_PROTO_SUCCESS, ERR_PROTO_CP_PARAM_INVALID or ERR_PROTO_CP_PARAM_OUT_RANGE
+ */
+int16_t proto_parse_dec(const char* str, uint16_t len, uint32_t max, uint32_t* value) {
+
+    if(len == 0) return ERR_PROTO_CP_PARAM_INVALID;
+
+    uint32_t v = 0;
+    for(uint16_t i=0; i<len; i++) {
+
+        uint8_t c = str[i];
+        if(c < '0' || c > '9') return ERR_PROTO_CP_PARAM_INVALID;
+
+        uint8_t digit = c - '0';
+        if(v > (max - digit) / 10) return ERR_PROTO_CP_PARAM_OUT_RANGE;
+        v = v * 10 + digit;
+    }
+
+    *value = v;
+    return ERR_PROTO_SUCCESS;
+}
+
+/**
+ * @brief proto_parse_arg - Parses one packet param into a typed value.
+ * @param pkt - Packet the param belongs to
+ * @param param - Param slice
+ * @param type - PROTO_ARG_* type
+ * @param arg - Parsed param
+ * @return ERR_PROTO_SUCCESS or a param error code
+ */
+int16_t proto_parse_arg(const proto_pkt_t* pkt, const proto_slice_t* param, char type, proto_arg_t* arg) {
+
+    const char* str = &pkt->buffer[param->offset];
+    uint32_t value = 0;
+    int16_t error_code = ERR_PROTO_SUCCESS;
+
+    switch(type)
+    {
+
+    case PROTO_ARG_HEX8:
+        error_code = proto_parse_hex(str, param->len, 0xFF, &value);
+        arg->u8 = value;
+        break;
+
+    case PROTO_ARG_HEX16:
+        error_code = proto_parse_hex(str, param->len, 0xFFFF, &value);
+        arg->u16 = value;
+        break;
+
+    case PROTO_ARG_HEX32:
+        error_code = proto_parse_hex(str, param->len, 0xFFFFFFFF, &value);
+        arg->u32 = value;
+        break;
+
+    case PROTO_ARG_COLOR:
+        error_code = proto_parse_hex(str, param->len, 0xFFFFFF, &value);
+        arg->u32 = value;
+        break;
+
+    case PROTO_ARG_DEC:
+        error_code = proto_parse_dec(str, param->len, 0xFFFFFFFF, &value);
+        arg->u32 = value;
+        break;
+
+    case PROTO_ARG_RAW:
+    default:
+        arg->slice = *param;
+        break;
+
+    }
+
+    return error_code;
+}
+
+/**
+ * @brief proto_find_cmd - Looks up a packet's command in a command table.
+ * @param table - Command table
+ * @param count - Number of commands in table
+ * @param pkt - Received packet
+ * @return Command table entry or NULL for an unknown command.
+ */
+const proto_cmd_t* proto_find_cmd(const proto_cmd_t* table, uint8_t count, const proto_pkt_t* pkt) {
+
+    const char* cmd = &pkt->buffer[pkt->cmd.offset];
+
+    for(uint8_t i=0; i<count; i++) {
+        if(strncmp(table[i].name, cmd, pkt->cmd.len) == 0 && table[i].name[pkt->cmd.len] == 0)
+            return &table[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief proto_next_param - Streams through a packet's params in order.
+ * @param pkt - Received packet
+ * @param cursor - Offset of the next param. Start with pkt->params.offset.
+ * @param param - Set to the next param
+ * @return false when there are no more params.
+ */
+bool proto_next_param(const proto_pkt_t* pkt, uint16_t* cursor, proto_slice_t* param) {
+
+    uint16_t end = pkt->params.offset + pkt->params.len;
+
+    if(pkt->param_count == 0 || *cursor > end) return false;
+
+    param->offset = *cursor;
+    while(*cursor < end && pkt->buffer[*cursor] != PROTO_PSC) (*cursor)++;
+    param->len = *cursor - param->offset;
+
+    (*cursor)++;    // Skip separator, moves past end after the last param
+    return true;
+}
+
+/**
+ * @brief proto_parse_args - Parses a packet's params using the command's param spec. Each param
+ * is parsed once here so handlers receive typed values.
+ * @param cmd - Command table entry
+ * @param pkt - Received packet
+ * @param args - Parsed params, room for cmd->max_args
+ * @return Number of params parsed or an error code.
+ */
+int16_t proto_parse_args(const proto_cmd_t* cmd, const proto_pkt_t* pkt, proto_arg_t* args) {
+
+    uint8_t spec_len = strlen(cmd->arg_spec);
+
+    if(pkt->param_count < cmd->min_args) return ERR_PROTO_CP_MISSING_PARAMS;
+    if(pkt->param_count > cmd->max_args || (spec_len == 0 && pkt->param_count > 0)) return ERR_PROTO_CP_TOO_MANY_PARAMS;
+
+    uint16_t cursor = pkt->params.offset;
+    proto_slice_t param;
+
+    for(uint16_t i=0; proto_next_param(pkt, &cursor, &param); i++) {
+        char type = cmd->arg_spec[i < spec_len ? i : spec_len - 1];
+        int16_t error_code = proto_parse_arg(pkt, &param, type, &args[i]);
+        if(error_code != ERR_PROTO_SUCCESS) return error_code;
+    }
+
+    return pkt->param_count;
+}
+
 /**
  * @brief proto_append_response_pkt_param - Appends a parameter to a packet if packet params has space.
  * @param pkt_rsp - Packet to append parameter to.
  * @param param - Parameter to add.
  * @return Packet parameter count.
  */
-int16_t proto_append_response_pkt_param(proto_pkt_t* pkt_rsp, const char *param) {
+int16_t proto_append_response_pkt_param(proto_rsp_t* pkt_rsp, const char *param) {
 
     if(pkt_rsp->param_count+1 > MAX_PROTO_PARAM_COUNT) return ERR_PROTO_RB_TOO_MANY_PARAMS;
     if(strlen(param) > MAX_PROTO_PARAM_LEN) return ERR_PROTO_RB_PARAM_OVERFLOW;
@@ -296,14 +677,39 @@ int16_t proto_append_response_pkt_param(proto_pkt_t* pkt_rsp, const char *param)
     return pkt_rsp->param_count;
 }
 
+/**
+ * @brief proto_set_response_pkt_payload - Sets a bulk param printed after all other params. The
+ * data is not copied and must stay valid until the packet is printed.
+ * @param pkt_rsp - Packet to set the payload on.
+ * @param payload - Payload characters.
+ * @param len - Number of payload characters.
+ */
+void proto_set_response_pkt_payload(proto_rsp_t* pkt_rsp, const char* payload, uint16_t len) {
+    pkt_rsp->payload = payload;
+    pkt_rsp->payload_len = len;
+}
+
 /**
  * @brief proto_set_response_pkt_error_code - Set the error code parameter for the given packet.
  * @param pkt_rsp - Packet to set error code on.
  * @param error_code - Error code to set.
  */
-void proto_set_response_pkt_error_code(proto_pkt_t* pkt_rsp, int16_t error_code) {
+void proto_set_response_pkt_error_code(proto_rsp_t* pkt_rsp, int16_t error_code) {
     if(pkt_rsp->param_count <= 0) pkt_rsp->param_count = 1;
     sprintf(pkt_rsp->params[0], "%d", error_code);
+    pkt_rsp->error_code = error_code;
+}
+
+/**
+ * @brief proto_init_response_pkt - Initialize response packet for a command. The default
+ * error code is Success. Use proto_set_response_pkt_error_code() to set a failure error code.
+ * @param pkt_rsp - Response packet.
+ * @param cmd - Command a response is being built for.
+ */
+void proto_init_response_pkt(proto_rsp_t* pkt_rsp, const char* cmd) {
+    proto_clear_pkt(pkt_rsp);
+    strlcpy(pkt_rsp->cmd, cmd, MAX_PROTO_CMD);
+    proto_set_response_pkt_error_code(pkt_rsp, ERR_PROTO_SUCCESS);
 }
 
 /**
@@ -312,9 +718,12 @@ void proto_set_response_pkt_error_code(proto_pkt_t* pkt_rsp, int16_t error_code)
  * @param pkt_rsp - Response packet.
  * @param pkt_cmd - Command packet a response is being built for.
  */
-void proto_init_response_pkt(proto_pkt_t* pkt_rsp, proto_pkt_t* pkt_cmd) {
+void proto_init_response_pkt(proto_rsp_t* pkt_rsp, const proto_pkt_t* pkt_cmd) {
     proto_clear_pkt(pkt_rsp);
-    strlcpy(pkt_rsp->cmd, pkt_cmd->cmd, MAX_PROTO_CMD);
+    if(pkt_cmd->buffer != NULL) {
+        uint16_t len = min(pkt_cmd->cmd.len, (uint16_t)(MAX_PROTO_CMD - 1));
+        memcpy(pkt_rsp->cmd, &pkt_cmd->buffer[pkt_cmd->cmd.offset], len);
+    }
     proto_set_response_pkt_error_code(pkt_rsp, ERR_PROTO_SUCCESS);
 }
 
@@ -322,7 +731,7 @@ void proto_init_response_pkt(proto_pkt_t* pkt_rsp, proto_pkt_t* pkt_cmd) {
  * @brief proto_print_response_pkt - Prints a packet to the serial port.
  * @param pkt_rsp - Packet to print
  */
-void proto_print_response_pkt(proto_pkt_t* pkt_rsp) {
+void proto_print_response_pkt(proto_rsp_t* pkt_rsp) {
 
     pkt_rsp->crc16 = 0;
 
@@ -344,6 +753,15 @@ void proto_print_response_pkt(proto_pkt_t* pkt_rsp) {
             i++;
         } while(i<pkt_rsp->param_count);
     }
+
+    if(pkt_rsp->payload != NULL) {
+        Serial.write(PROTO_PSC);
+        pkt_rsp->crc16 = crc16(pkt_rsp->crc16, PROTO_PSC);
+
+        Serial.write(pkt_rsp->payload, pkt_rsp->payload_len);
+        pkt_rsp->crc16 = crc16_buffer(pkt_rsp->crc16, (char*)pkt_rsp->payload, 0, pkt_rsp->payload_len);
+    }
+
     Serial.write(PROTO_ETX);
     pkt_rsp->crc16 = crc16(pkt_rsp->crc16, PROTO_ETX);
     Serial.print(pkt_rsp->crc16, HEX);
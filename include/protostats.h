@@ -0,0 +1,160 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef PROTOSTATS_H
+#define PROTOSTATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "protocol.h"
+
+
+#define PROTO_STATS_FIRST_ERROR     ERR_PROTO_CMD_PARSING           // First command processing error code counted
+#define PROTO_STATS_LAST_ERROR      ERR_PROTO_CP_TOO_MANY_PARAMS    // Last command processing error code counted
+#define PROTO_STATS_ERROR_COUNT     (PROTO_STATS_FIRST_ERROR - PROTO_STATS_LAST_ERROR + 1)
+
+
+/* *
+ * Per command counters
+ * */
+typedef struct proto_cmd_stats_struct
+{
+    uint32_t count;                                 // Packets received for the command
+    uint32_t handlerUs;                             // Total time its handler ran
+    uint32_t handlerMaxUs;                          // Longest its handler ran
+} proto_cmd_stats_t;
+
+
+/* *
+ * ProtoStats - Counters of the command protocol's health, for diagnosing degraded serial links and
+ * hosts that send too much.
+ *
+ * Counts bytes and packets received, input buffer overflows, each command processing error code,
+ * ERR_PROTO_CMD_PARSING to ERR_PROTO_CP_TOO_MANY_PARAMS, and packets and handler time for each entry
+ * of a command table. Counters run from startup and wrap, readers work with the difference between
+ * two reads.
+ * */
+template<uint8_t Commands>
+class ProtoStats
+{
+
+private:
+    uint32_t m_bytes;                               // Bytes received
+    uint32_t m_packets;                             // Packets received, whether they parsed or not
+    uint32_t m_overflows;                           // Input buffer overflows
+    uint32_t m_errors[PROTO_STATS_ERROR_COUNT];     // Count of each error code, from PROTO_STATS_FIRST_ERROR down
+    proto_cmd_stats_t m_commands[Commands];         // Counters for each command table entry
+
+public:
+
+    ProtoStats() :
+        m_bytes(0),
+        m_packets(0),
+        m_overflows(0)
+    {
+        memset(m_errors, 0, sizeof(m_errors));
+        memset(m_commands, 0, sizeof(m_commands));
+    }
+
+    void received(uint32_t bytes)
+    {
+        m_bytes += bytes;
+    }
+
+    void packet()
+    {
+        m_packets++;
+    }
+
+    void overflow()
+    {
+        m_overflows++;
+    }
+
+    /**
+     * @brief error - Counts an error code, codes outside the counted range are ignored
+     * @param code
+     */
+    void error(int16_t code)
+    {
+        if(code <= PROTO_STATS_FIRST_ERROR && code >= PROTO_STATS_LAST_ERROR)
+            m_errors[PROTO_STATS_FIRST_ERROR - code]++;
+    }
+
+    /**
+     * @brief command - Counts a packet received for a command
+     * @param index - Command table index
+     */
+    void command(uint8_t index)
+    {
+        if(index < Commands) m_commands[index].count++;
+    }
+
+    /**
+     * @brief handled - Adds the time a command's handler ran
+     * @param index - Command table index
+     * @param us - Handler time
+     */
+    void handled(uint8_t index, uint32_t us)
+    {
+        if(index >= Commands) return;
+
+        m_commands[index].handlerUs += us;
+        if(us > m_commands[index].handlerMaxUs) m_commands[index].handlerMaxUs = us;
+    }
+
+    uint32_t bytes() const
+    {
+        return m_bytes;
+    }
+
+    uint32_t packets() const
+    {
+        return m_packets;
+    }
+
+    uint32_t overflows() const
+    {
+        return m_overflows;
+    }
+
+    /**
+     * @brief errors - Get the count of an error code
+     * @param code - PROTO_STATS_FIRST_ERROR to PROTO_STATS_LAST_ERROR
+     * @return 0 for codes outside the counted range
+     */
+    uint32_t errors(int16_t code) const
+    {
+        if(code > PROTO_STATS_FIRST_ERROR || code < PROTO_STATS_LAST_ERROR) return 0;
+        return m_errors[PROTO_STATS_FIRST_ERROR - code];
+    }
+
+    /**
+     * @brief commandStats - Get the counters of a command
+     * @param index - Command table index, less than Commands
+     * @return
+     */
+    const proto_cmd_stats_t& commandStats(uint8_t index) const
+    {
+        return m_commands[index];
+    }
+
+};
+
+#endif // PROTOSTATS_H
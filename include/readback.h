@@ -0,0 +1,223 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef READBACK_H
+#define READBACK_H
+
+#include <Arduino.h>
+#define FASTLED_INTERNAL
+#include <FastLED.h>
+#include "protocol.h"
+
+
+/* *
+ * Frame readback sources
+ * */
+typedef enum AvailableReadbackSources
+{
+    FrameBuffer = 0x00,     // leds[] as drawn by the effect, before brightness
+    FrameOutput,            // leds[] after brightness, power limiting and color correction
+    MaxReadbackSource
+} ReadbackSource_t;
+
+/* *
+ * Frame readback encodings. Pixels are run length encoded, each run is a 1 byte run length
+ * followed by the run's color. Encoded bytes are sent as HEX.
+ * */
+typedef enum AvailableReadbackEncodings
+{
+    RleRGB888 = 0x00,       // Run color is 24bit RGB
+    RleRGB332,              // Run color is an 8bit index into a fixed 3-3-2 RGB pallet
+    MaxReadbackEncoding
+} ReadbackEncoding_t;
+
+
+/**
+ * @brief frame_checksum - Calculates the CRC16 of a frame buffer, the same CRC a host calculates
+ * over the RGB bytes of a RleRGB888 readback of it without downsampling
+ * @param leds - Frame buffer
+ * @param count - Number of pixels in the frame buffer
+ * @param scale - Per channel scale, 255 leaves the channel unchanged
+ * @return
+ */
+inline uint16_t frame_checksum(const CRGB* leds, uint16_t count, CRGB scale)
+{
+    uint16_t crc = 0;
+
+    for(uint16_t i = 0; i < count; i++) {
+        crc = crc16(crc, scale8(leds[i].r, scale.r));
+        crc = crc16(crc, scale8(leds[i].g, scale.g));
+        crc = crc16(crc, scale8(leds[i].b, scale.b));
+    }
+
+    return crc;
+}
+
+
+/* *
+ * FrameReadback - Encodes a frame a chunk at a time so a readback can be streamed between frames
+ * without blocking rendering.
+ *
+ * The frame is sampled, scaled and downsampled into the readback's own pixels when it begins, so
+ * every chunk of a readback comes from the same frame however many frames are rendered while it
+ * is being sent.
+ * */
+template<uint16_t MaxPixels>
+class FrameReadback
+{
+
+private:
+    uint8_t m_frame[MaxPixels * 3];     // Readback pixels, RGB, sampled when the readback began
+    uint16_t m_count;                   // Number of readback pixels
+    uint16_t m_pos;                     // Next readback pixel to encode
+    ReadbackEncoding_t m_encoding;      // Pixel encoding
+    bool m_active;                      // Readback in progress
+
+    /**
+     * @brief color - Gets the encoded color of a readback pixel
+     * @param pos
+     * @return 24bit RGB or 8bit RGB332 color
+     */
+    uint32_t color(uint16_t pos) const
+    {
+        const uint8_t* p = m_frame + pos * 3;
+
+        if(m_encoding == RleRGB332)
+            return (p[0] & 0xE0) | ((p[1] & 0xE0) >> 3) | (p[2] >> 6);
+
+        return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    }
+
+    static char* writeHex(char* out, uint32_t value, uint8_t bytes)
+    {
+        static const char digits[] = "0123456789ABCDEF";
+
+        for(int8_t i = bytes * 2 - 1; i >= 0; i--)
+            *out++ = digits[(value >> (i * 4)) & 0x0F];
+
+        return out;
+    }
+
+public:
+
+    FrameReadback() :
+        m_count(0),
+        m_pos(0),
+        m_encoding(RleRGB888),
+        m_active(false)
+    {
+
+    }
+
+    /**
+     * @brief begin - Starts a readback of the frame buffer as it is now, replacing any readback
+     * in progress
+     * @param leds - Frame buffer
+     * @param count - Number of pixels in the frame buffer, at most MaxPixels
+     * @param encoding - Pixel encoding
+     * @param downsample - Frame buffer pixels averaged into each readback pixel
+     * @param scale - Per channel scale, 255 leaves the channel unchanged
+     */
+    void begin(const CRGB* leds, uint16_t count, ReadbackEncoding_t encoding, uint8_t downsample, CRGB scale)
+    {
+        downsample = max(downsample, (uint8_t)1);
+        count = min(count, (uint16_t)MaxPixels);
+
+        m_count = (count + downsample - 1) / downsample;
+        m_pos = 0;
+        m_encoding = encoding;
+        m_active = count > 0;
+
+        uint8_t* p = m_frame;
+
+        for(uint16_t pos = 0; pos < count; pos += downsample) {
+
+            uint16_t end = min((uint16_t)(pos + downsample), count);
+            uint16_t n = end - pos;
+            uint32_t r = 0, g = 0, b = 0;
+
+            for(uint16_t i = pos; i < end; i++) {
+                r += leds[i].r;
+                g += leds[i].g;
+                b += leds[i].b;
+            }
+
+            *p++ = scale8(r / n, scale.r);
+            *p++ = scale8(g / n, scale.g);
+            *p++ = scale8(b / n, scale.b);
+        }
+    }
+
+    /**
+     * @brief active - Get whether a readback is in progress
+     * @return
+     */
+    bool active() const
+    {
+        return m_active;
+    }
+
+    /**
+     * @brief pixelCount - Get the number of pixels in the readback after downsampling
+     * @return
+     */
+    uint16_t pixelCount() const
+    {
+        return m_count;
+    }
+
+    /**
+     * @brief nextChunk - Encodes the next chunk of the readback. The readback is finished once
+     * a chunk reaching the last pixel has been encoded.
+     * @param out - HEX output
+     * @param maxChars - Size of out
+     * @param firstPixel - Set to the readback pixel index the chunk starts at
+     * @return Number of characters written to out
+     */
+    uint16_t nextChunk(char* out, uint16_t maxChars, uint16_t* firstPixel)
+    {
+        const uint8_t colorBytes = m_encoding == RleRGB332 ? 1 : 3;
+        const uint16_t runChars = (1 + colorBytes) * 2;
+        char* start = out;
+
+        *firstPixel = m_pos;
+
+        while(m_active && (uint16_t)(out - start) + runChars <= maxChars) {
+
+            uint32_t runColor = color(m_pos);
+            uint8_t run = 1;
+            m_pos++;
+
+            while(m_pos < m_count && run < 255 && color(m_pos) == runColor) {
+                run++;
+                m_pos++;
+            }
+
+            out = writeHex(out, run, 1);
+            out = writeHex(out, runColor, colorBytes);
+
+            if(m_pos >= m_count) m_active = false;
+        }
+
+        return out - start;
+    }
+
+};
+
+#endif // READBACK_H
@@ -0,0 +1,161 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* *
+ * PacketRecorder - Records received packets with their receipt time so a command stream can be
+ * read back and replayed.
+ *
+ * Only the packet body between STX and ETX is kept. Records are packed back to back in a single
+ * pool, each one a 4 byte time in microseconds since recording started, a 2 byte length and the
+ * body. Once the pool is full further packets are counted as dropped rather than evicting the
+ * start of the recording.
+ * */
+template<size_t PoolSize>
+class PacketRecorder
+{
+
+private:
+    static const size_t HeaderSize = 6;
+
+    uint8_t m_pool[PoolSize];                   // Packed records
+    size_t m_used;                              // Bytes of m_pool in use
+    uint16_t m_count;                           // Number of records
+    uint16_t m_dropped;                         // Packets that didn't fit
+    uint32_t m_startUs;                         // Time recording started
+    bool m_recording;                           // Recording in progress
+
+    // Cursor so reading the records in order doesn't walk the pool from the start each time
+    uint16_t m_readIndex;
+    size_t m_readOffset;
+
+public:
+
+    PacketRecorder() :
+        m_used(0),
+        m_count(0),
+        m_dropped(0),
+        m_startUs(0),
+        m_recording(false),
+        m_readIndex(0),
+        m_readOffset(0)
+    {
+
+    }
+
+    /**
+     * @brief start - Clears any previous recording and starts recording
+     * @param nowUs - Current time in microseconds
+     */
+    void start(uint32_t nowUs)
+    {
+        m_used = 0;
+        m_count = 0;
+        m_dropped = 0;
+        m_startUs = nowUs;
+        m_readIndex = 0;
+        m_readOffset = 0;
+        m_recording = true;
+    }
+
+    /**
+     * @brief stop - Stops recording, the records are kept until the next start
+     */
+    void stop()
+    {
+        m_recording = false;
+    }
+
+    bool recording() const
+    {
+        return m_recording;
+    }
+
+    uint16_t count() const
+    {
+        return m_count;
+    }
+
+    uint16_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    /**
+     * @brief record - Records a packet body if recording
+     * @param timeUs - Receipt time in microseconds
+     * @param body - Packet body
+     * @param len - Body length
+     */
+    void record(uint32_t timeUs, const char* body, uint16_t len)
+    {
+        if(!m_recording) return;
+
+        if(m_used + HeaderSize + len > PoolSize || m_count == UINT16_MAX) {
+            if(m_dropped < UINT16_MAX) m_dropped++;
+            return;
+        }
+
+        uint32_t t = timeUs - m_startUs;
+        memcpy(&m_pool[m_used], &t, 4);
+        memcpy(&m_pool[m_used + 4], &len, 2);
+        memcpy(&m_pool[m_used + HeaderSize], body, len);
+
+        m_used += HeaderSize + len;
+        m_count++;
+    }
+
+    /**
+     * @brief get - Gets a record
+     * @param index - Record index, oldest first
+     * @param timeUs - Set to the time since recording started
+     * @param len - Set to the body length
+     * @return Pointer to the body or nullptr when index is out of range
+     */
+    const char* get(uint16_t index, uint32_t* timeUs, uint16_t* len)
+    {
+        if(index >= m_count) return nullptr;
+
+        if(index < m_readIndex) {
+            m_readIndex = 0;
+            m_readOffset = 0;
+        }
+
+        while(m_readIndex < index) {
+            uint16_t skip;
+            memcpy(&skip, &m_pool[m_readOffset + 4], 2);
+            m_readOffset += HeaderSize + skip;
+            m_readIndex++;
+        }
+
+        memcpy(timeUs, &m_pool[m_readOffset], 4);
+        memcpy(len, &m_pool[m_readOffset + 4], 2);
+        return (const char*)&m_pool[m_readOffset + HeaderSize];
+    }
+
+};
+
+#endif // RECORDER_H
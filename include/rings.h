@@ -0,0 +1,311 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef RINGS_H
+#define RINGS_H
+
+#include <Arduino.h>
+#define FASTLED_INTERNAL
+#include <FastLED.h>
+
+
+#define RING_REVERSED               0x01            // LEDs are wired counterclockwise
+#define RING_FLAGS                  0x01            // All RING_* flags
+
+
+/* *
+ * Ring - One ring or fan of LEDs
+ * */
+typedef struct ring_struct
+{
+    uint16_t first;         // Strip index of the ring's first LED
+    uint8_t size;           // Number of LEDs
+    uint8_t offset;         // LED at the top, counted from the first in wiring order
+    uint8_t flags;          // RING_*
+    uint8_t radius;         // Distance from the centre, 0-255, for rings drawn together as a disc
+} ring_t;
+
+
+/**
+ * @brief ring_code_valid - Checks a ring code from Set Rings, 0xSSOOFFRR
+ * @param code
+ * @return
+ */
+inline bool ring_code_valid(uint32_t code)
+{
+    uint8_t size = code >> 24;
+    uint8_t offset = code >> 16;
+    uint8_t flags = code >> 8;
+
+    return size > 0 && offset < size && (flags & ~RING_FLAGS) == 0;
+}
+
+
+/* *
+ * RingGeometry - Maps angles on rings of LEDs to strip indexes.
+ *
+ * Rings are wired one after another from the start of the strip. Each has its own size, the LED
+ * at its top, the direction it is wired in and a radius. Radius only matters to drawing across
+ * rings: concentric rings have increasing radii, separate fans can share one.
+ *
+ * Angles are 16bit, 0 at the top and increasing clockwise, 0x10000 for a full turn. Adding a ring
+ * fills in its part of one index table, the strip index of each LED in clockwise order from the
+ * top, and an angle table of the centre of each. Every primitive draws through them, so none does
+ * any per pixel geometry. Drawing adds to the frame like DrawPixels(), and pixels past the active
+ * strip length are skipped.
+ *      fillRing    - Every LED of a ring
+ *      drawArc     - A part of a ring, with the LEDs at the ends lit by how much of them it covers
+ *      drawRadar   - A beam with a trail fading out behind it
+ *      drawRadial  - A line out from the centre across the rings within a range of radii, split
+ *                    between the 2 LEDs either side of the angle on each
+ *      fillRadius  - Every LED of the rings within a range of radii
+ * */
+template<uint8_t MaxRings, uint16_t MaxLeds>
+class RingGeometry
+{
+
+private:
+    ring_t m_rings[MaxRings];                       // Rings in wiring order
+    uint8_t m_count;                                // Number of rings
+    uint16_t m_leds;                                // LEDs in all rings
+    uint16_t m_index[MaxLeds];                      // Strip index of each LED clockwise from the top, by ring
+    uint16_t m_angle[MaxLeds];                      // Angle of each LED in m_index
+
+    /**
+     * @brief add - Adds color scaled to a strip pixel if it's on the strip
+     */
+    static void add(CRGB* leds, uint16_t numLeds, uint16_t index, const CRGB& color, uint8_t scale)
+    {
+        if(index < numLeds && scale > 0) leds[index] += CRGB(color).nscale8(scale);
+    }
+
+public:
+
+    RingGeometry() :
+        m_count(0),
+        m_leds(0)
+    {
+
+    }
+
+    /**
+     * @brief clear - Removes all rings
+     */
+    void clear()
+    {
+        m_count = 0;
+        m_leds = 0;
+    }
+
+    /**
+     * @brief addRing - Adds a ring wired after the previous one
+     * @param size - Number of LEDs
+     * @param offset - LED at the top, counted from the ring's first in wiring order
+     * @param flags - RING_*
+     * @param radius - Distance from the centre, 0-255
+     * @return false if the ring is invalid or there is no room for it
+     */
+    bool addRing(uint8_t size, uint8_t offset, uint8_t flags, uint8_t radius)
+    {
+        if(m_count >= MaxRings || size == 0 || offset >= size || (flags & ~RING_FLAGS) != 0
+                || m_leds + size > MaxLeds)
+            return false;
+
+        ring_t& ring = m_rings[m_count++];
+        ring.first = m_leds;
+        ring.size = size;
+        ring.offset = offset;
+        ring.flags = flags;
+        ring.radius = radius;
+
+        for(uint16_t k = 0; k < size; k++) {
+            uint16_t led = (flags & RING_REVERSED) ? (offset + size - k) % size : (offset + k) % size;
+            m_index[ring.first + k] = ring.first + led;
+            m_angle[ring.first + k] = ((uint32_t)k << 16) / size;
+        }
+
+        m_leds += size;
+        return true;
+    }
+
+    uint8_t count() const
+    {
+        return m_count;
+    }
+
+    /**
+     * @brief leds - Get the number of LEDs in all rings
+     * @return
+     */
+    uint16_t leds() const
+    {
+        return m_leds;
+    }
+
+    const ring_t& ring(uint8_t r) const
+    {
+        return m_rings[r];
+    }
+
+    /**
+     * @brief pixel - Get the strip index of an LED
+     * @param r - Ring
+     * @param k - LED clockwise from the top, 0 to the ring's size - 1
+     * @return
+     */
+    uint16_t pixel(uint8_t r, uint8_t k) const
+    {
+        return m_index[m_rings[r].first + k];
+    }
+
+    /**
+     * @brief angle - Get the angle of an LED
+     * @param r - Ring
+     * @param k - LED clockwise from the top, 0 to the ring's size - 1
+     * @return
+     */
+    uint16_t angle(uint8_t r, uint8_t k) const
+    {
+        return m_angle[m_rings[r].first + k];
+    }
+
+    /**
+     * @brief radiusRange - Get the smallest and largest radius of the rings
+     * @param minRadius
+     * @param maxRadius
+     */
+    void radiusRange(uint8_t& minRadius, uint8_t& maxRadius) const
+    {
+        minRadius = 255;
+        maxRadius = 0;
+        for(uint8_t r = 0; r < m_count; r++) {
+            if(m_rings[r].radius < minRadius) minRadius = m_rings[r].radius;
+            if(m_rings[r].radius > maxRadius) maxRadius = m_rings[r].radius;
+        }
+    }
+
+    /**
+     * @brief fillRing - Adds a color to every LED of a ring
+     * @param leds - Frame buffer
+     * @param numLeds - Active strip length
+     * @param r - Ring
+     * @param color
+     */
+    void fillRing(CRGB* leds, uint16_t numLeds, uint8_t r, const CRGB& color) const
+    {
+        const ring_t& ring = m_rings[r];
+        for(uint16_t k = 0; k < ring.size; k++) add(leds, numLeds, m_index[ring.first + k], color, 255);
+    }
+
+    /**
+     * @brief drawArc - Adds a color to a part of a ring. Each LED covers the ring from half way
+     * to the LED before it to half way to the one after, and is lit by how much of that the
+     * arc covers.
+     * @param leds - Frame buffer
+     * @param numLeds - Active strip length
+     * @param r - Ring
+     * @param start - Angle the arc starts at
+     * @param width - Angle the arc covers clockwise from start
+     * @param color
+     */
+    void drawArc(CRGB* leds, uint16_t numLeds, uint8_t r, uint16_t start, uint16_t width, const CRGB& color) const
+    {
+        const ring_t& ring = m_rings[r];
+        const int32_t span = 0x10000 / ring.size;
+
+        for(uint16_t k = 0; k < ring.size; k++) {
+
+            // Where the LED's span starts, relative to the arc, and its overlap with the arc
+            int32_t from = (uint16_t)(m_angle[ring.first + k] - span / 2 - start);
+            int32_t to = from + span;
+            int32_t overlap = max((int32_t)0, min(to, (int32_t)width) - from);
+
+            // The end of the LED's span may wrap round past the start of the arc
+            if(to > 0x10000) overlap += min(to - 0x10000, (int32_t)width);
+
+            add(leds, numLeds, m_index[ring.first + k], color, min(overlap * 255 / span, (int32_t)255));
+        }
+    }
+
+    /**
+     * @brief drawRadar - Adds a beam to a ring, with a trail behind it fading out linearly
+     * @param leds - Frame buffer
+     * @param numLeds - Active strip length
+     * @param r - Ring
+     * @param beam - Angle of the beam
+     * @param trail - Angle the trail covers behind the beam, counterclockwise
+     * @param color
+     */
+    void drawRadar(CRGB* leds, uint16_t numLeds, uint8_t r, uint16_t beam, uint16_t trail, const CRGB& color) const
+    {
+        if(trail == 0) return;
+
+        const ring_t& ring = m_rings[r];
+        const uint32_t fade = (255UL << 16) / trail;
+
+        for(uint16_t k = 0; k < ring.size; k++) {
+            uint16_t behind = beam - m_angle[ring.first + k];
+            if(behind < trail) add(leds, numLeds, m_index[ring.first + k], color, 255 - ((behind * fade) >> 16));
+        }
+    }
+
+    /**
+     * @brief drawRadial - Adds a line out from the centre at an angle to every ring within a range
+     * of radii. On each ring the line is split between the LEDs either side of the angle.
+     * @param leds - Frame buffer
+     * @param numLeds - Active strip length
+     * @param angle
+     * @param inner - Smallest radius drawn
+     * @param outer - Largest radius drawn
+     * @param color
+     */
+    void drawRadial(CRGB* leds, uint16_t numLeds, uint16_t angle, uint8_t inner, uint8_t outer, const CRGB& color) const
+    {
+        for(uint8_t r = 0; r < m_count; r++) {
+
+            const ring_t& ring = m_rings[r];
+            if(ring.radius < inner || ring.radius > outer) continue;
+
+            uint32_t position = (uint32_t)angle * ring.size;
+            uint8_t k = position >> 16;
+            uint8_t frac = position >> 8;
+
+            add(leds, numLeds, m_index[ring.first + k], color, 255 - frac);
+            add(leds, numLeds, m_index[ring.first + (k + 1) % ring.size], color, frac);
+        }
+    }
+
+    /**
+     * @brief fillRadius - Adds a color to every ring within a range of radii
+     * @param leds - Frame buffer
+     * @param numLeds - Active strip length
+     * @param inner - Smallest radius drawn
+     * @param outer - Largest radius drawn
+     * @param color
+     */
+    void fillRadius(CRGB* leds, uint16_t numLeds, uint8_t inner, uint8_t outer, const CRGB& color) const
+    {
+        for(uint8_t r = 0; r < m_count; r++) {
+            if(m_rings[r].radius >= inner && m_rings[r].radius <= outer) fillRing(leds, numLeds, r, color);
+        }
+    }
+
+};
+
+#endif // RINGS_H
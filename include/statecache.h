@@ -0,0 +1,149 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef STATECACHE_H
+#define STATECACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* *
+ * StateCache - Small fixed size cache of serialized effect states keyed by effect code.
+ *
+ * States are packed back to back in a single pool in the order they were stored. Storing a state
+ * for a key replaces the previous one and when the pool is full the oldest states are evicted to
+ * make room.
+ * */
+template<size_t PoolSize, uint8_t MaxEntries = 8>
+class StateCache
+{
+
+private:
+
+    typedef struct state_entry_struct
+    {
+        uint8_t key;                            // Effect code the state belongs to
+        uint16_t offset;                        // Offset of the state in m_pool
+        uint16_t len;                           // Length of the state in bytes
+    } state_entry_t;
+
+    uint8_t m_pool[PoolSize];                   // Packed state data
+    state_entry_t m_entries[MaxEntries];        // Entries, oldest first
+    uint8_t m_count;                            // Number of entries
+    size_t m_used;                              // Bytes of m_pool in use
+
+    int16_t indexOf(uint8_t key) const
+    {
+        for(uint8_t i = 0; i < m_count; i++)
+            if(m_entries[i].key == key) return i;
+
+        return -1;
+    }
+
+    void removeAt(uint8_t index)
+    {
+        const state_entry_t removed = m_entries[index];
+        const size_t tail = m_used - (removed.offset + removed.len);
+
+        memmove(&m_pool[removed.offset], &m_pool[removed.offset + removed.len], tail);
+        m_used -= removed.len;
+
+        for(uint8_t i = index; i + 1 < m_count; i++) {
+            m_entries[i] = m_entries[i + 1];
+            m_entries[i].offset -= removed.len;
+        }
+
+        m_count--;
+    }
+
+public:
+
+    StateCache() :
+        m_count(0),
+        m_used(0)
+    {
+
+    }
+
+    /**
+     * @brief reserve - Reserve space for the state of key, replacing any state already cached
+     * for it and evicting the oldest states if needed.
+     * @param key - Effect code
+     * @param len - Size of the state in bytes
+     * @return Pointer to write the state to or nullptr if it can never fit.
+     */
+    uint8_t* reserve(uint8_t key, size_t len)
+    {
+        erase(key);
+
+        if(len == 0 || len > PoolSize) return nullptr;
+
+        while(m_count > 0 && (m_count >= MaxEntries || m_used + len > PoolSize))
+            removeAt(0);
+
+        state_entry_t& entry = m_entries[m_count++];
+        entry.key = key;
+        entry.offset = m_used;
+        entry.len = len;
+        m_used += len;
+
+        return &m_pool[entry.offset];
+    }
+
+    /**
+     * @brief find - Look up the cached state for key
+     * @param key - Effect code
+     * @param len - Set to the state length when found
+     * @return Pointer to the state or nullptr when none is cached.
+     */
+    const uint8_t* find(uint8_t key, size_t& len) const
+    {
+        int16_t index = indexOf(key);
+
+        if(index < 0) return nullptr;
+
+        len = m_entries[index].len;
+        return &m_pool[m_entries[index].offset];
+    }
+
+    /**
+     * @brief erase - Drop the cached state for key if there is one
+     * @param key - Effect code
+     */
+    void erase(uint8_t key)
+    {
+        int16_t index = indexOf(key);
+
+        if(index >= 0) removeAt(index);
+    }
+
+    /**
+     * @brief clear - Drop all cached states
+     */
+    void clear()
+    {
+        m_count = 0;
+        m_used = 0;
+    }
+
+};
+
+#endif // STATECACHE_H
@@ -0,0 +1,297 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef TEMPO_H
+#define TEMPO_H
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define TEMPO_MIN_BPM               2000            // Slowest tempo, BPM * 100
+#define TEMPO_MAX_BPM               30000           // Fastest tempo, BPM * 100
+#define TEMPO_DEFAULT_BPM           12000           // Tempo until one is set, BPM * 100
+#define TEMPO_MAX_BEATS_PER_BAR     16              // Longest bar
+
+#define TEMPO_EVENT_BEAT            0x01            // A beat started
+#define TEMPO_EVENT_BAR             0x02            // A bar started, always with TEMPO_EVENT_BEAT
+
+
+/* *
+ * Tempo listener - Called by TempoClock::update() when a beat or bar starts
+ * params
+ * - TEMPO_EVENT_* flags
+ * - Beat number, counting up from when the clock started and wrapping at 16 bits
+ * */
+typedef void (*tempo_listener_t)(uint8_t events, uint16_t beat);
+
+
+/* *
+ * TempoClock - Keeps the beat for effects that lock to a tempo.
+ *
+ * The phase is a fixed point count of beats, 16 bits of beat number and 48 bits of fraction,
+ * advanced by the elapsed time times a per millisecond rate worked out once when the tempo is
+ * set. At 48 bits the rate's rounding drifts by less than a beat in a year, so the clock runs
+ * free between tempo changes and the host only sends changes, never per beat commands that
+ * would carry the serial link's timing jitter onto the beat.
+ *
+ * The tempo is set directly, or tapped: each tap lands on a beat and, from the second tap on,
+ * the tempo is the average interval of the last MaxTaps taps. A pause longer than TapTimeoutMs
+ * starts a new run of taps, whose first tap is the start of a bar.
+ *
+ * Listeners are called from update() each time a beat starts, with TEMPO_EVENT_BAR set on the
+ * first beat of a bar.
+ * */
+class TempoClock
+{
+
+private:
+    static const uint8_t Shift = 48;                // Fraction bits of the phase
+    static const uint8_t MaxTaps = 8;               // Taps averaged for the tempo
+    static const uint16_t TapTimeoutMs = 2000;      // Pause that starts a new run of taps
+    static const uint8_t MaxListeners = 4;          // Listeners that can subscribe
+
+    uint64_t m_phase;                               // Beats, 16.48 fixed point
+    uint64_t m_rate;                                // Phase per millisecond
+    uint16_t m_bpm;                                 // Tempo, BPM * 100
+    uint8_t m_beatsPerBar;                          // Beats in a bar
+    uint8_t m_beatInBar;                            // Beat of the bar the phase is in
+    uint32_t m_lastMs;                              // Time of the last update
+    uint32_t m_taps[MaxTaps];                       // Times of the current run of taps, oldest first
+    uint8_t m_tapCount;                             // Taps in m_taps
+    tempo_listener_t m_listeners[MaxListeners];     // Subscribed listeners, nullptr when free
+
+public:
+
+    TempoClock() :
+        m_phase(0),
+        m_rate(0),
+        m_bpm(0),
+        m_beatsPerBar(4),
+        m_beatInBar(0),
+        m_lastMs(0),
+        m_tapCount(0)
+    {
+        memset(m_listeners, 0, sizeof(m_listeners));
+        setBpm(TEMPO_DEFAULT_BPM);
+    }
+
+    /**
+     * @brief setBpm - Sets the tempo, the phase carries on from where it is
+     * @param bpm - BPM * 100, TEMPO_MIN_BPM to TEMPO_MAX_BPM
+     * @return false if bpm is out of range and was not set
+     */
+    bool setBpm(uint16_t bpm)
+    {
+        if(bpm < TEMPO_MIN_BPM || bpm > TEMPO_MAX_BPM)
+            return false;
+
+        // Beats per millisecond is bpm / 100 / 60000
+        m_bpm = bpm;
+        m_rate = ((uint64_t)bpm << Shift) / 6000000;
+        return true;
+    }
+
+    /**
+     * @brief bpm - Get the tempo
+     * @return BPM * 100
+     */
+    uint16_t bpm() const
+    {
+        return m_bpm;
+    }
+
+    /**
+     * @brief setBeatsPerBar - Sets the number of beats in a bar
+     * @param beats - 1 to TEMPO_MAX_BEATS_PER_BAR
+     * @return false if beats is out of range and was not set
+     */
+    bool setBeatsPerBar(uint8_t beats)
+    {
+        if(beats == 0 || beats > TEMPO_MAX_BEATS_PER_BAR)
+            return false;
+
+        m_beatsPerBar = beats;
+        m_beatInBar %= beats;
+        return true;
+    }
+
+    uint8_t beatsPerBar() const
+    {
+        return m_beatsPerBar;
+    }
+
+    /**
+     * @brief setPhase - Moves the clock to a point in the current beat, to line it up with the
+     * host's beat. Listeners aren't called for the jump.
+     * @param phase - Point in the beat, 0 is the start of the beat and 0xFFFF the end
+     * @param nowMs - Current time
+     */
+    void setPhase(uint16_t phase, uint32_t nowMs)
+    {
+        update(nowMs);
+        m_phase = (m_phase & ~(((uint64_t)1 << Shift) - 1)) | ((uint64_t)phase << (Shift - 16));
+    }
+
+    /**
+     * @brief tap - Taps a beat. The clock is moved to the start of the nearest beat and from the
+     * second tap of a run the tempo is set from the taps.
+     * @param nowMs - Time of the tap
+     * @return true if the tempo was set
+     */
+    bool tap(uint32_t nowMs)
+    {
+        update(nowMs);
+
+        if(m_tapCount > 0 && nowMs - m_taps[m_tapCount - 1] > TapTimeoutMs)
+            m_tapCount = 0;
+
+        if(m_tapCount == MaxTaps) {
+            memmove(m_taps, m_taps + 1, (MaxTaps - 1) * sizeof(m_taps[0]));
+            m_tapCount--;
+        }
+
+        m_taps[m_tapCount++] = nowMs;
+
+        // Round to the nearest beat, a tap is as likely a little early as late
+        uint64_t beat = (m_phase + ((uint64_t)1 << (Shift - 1))) >> Shift;
+        if(beat != (m_phase >> Shift))
+            m_beatInBar = (m_beatInBar + 1) % m_beatsPerBar;
+        m_phase = beat << Shift;
+
+        if(m_tapCount == 1) {
+            m_beatInBar = 0;
+            return false;
+        }
+
+        uint32_t intervalMs = (m_taps[m_tapCount - 1] - m_taps[0]) / (m_tapCount - 1);
+        if(intervalMs == 0)
+            return false;
+
+        uint32_t bpm = 6000000 / intervalMs;
+        if(bpm < TEMPO_MIN_BPM) bpm = TEMPO_MIN_BPM;
+        if(bpm > TEMPO_MAX_BPM) bpm = TEMPO_MAX_BPM;
+
+        return setBpm(bpm);
+    }
+
+    /**
+     * @brief update - Advances the clock to the current time, calling the listeners if a beat
+     * started. Several beats passing at once, after a long gap, are reported once.
+     * @param nowMs - Current time
+     */
+    void update(uint32_t nowMs)
+    {
+        uint32_t elapsed = nowMs - m_lastMs;
+        m_lastMs = nowMs;
+
+        if(elapsed == 0)
+            return;
+
+        uint16_t before = m_phase >> Shift;
+        m_phase += elapsed * m_rate;
+        uint16_t beats = (uint16_t)(m_phase >> Shift) - before;
+
+        if(beats == 0)
+            return;
+
+        uint8_t events = TEMPO_EVENT_BEAT;
+        if(m_beatInBar + beats >= m_beatsPerBar)
+            events |= TEMPO_EVENT_BAR;
+        m_beatInBar = (m_beatInBar + beats) % m_beatsPerBar;
+
+        for(uint8_t i = 0; i < MaxListeners; i++) {
+            if(m_listeners[i] != nullptr)
+                m_listeners[i](events, beat());
+        }
+    }
+
+    /**
+     * @brief beat - Get the beat number, counting up from when the clock started
+     * @return
+     */
+    uint16_t beat() const
+    {
+        return m_phase >> Shift;
+    }
+
+    /**
+     * @brief beatPhase - Get how far through the current beat the clock is
+     * @return 0 at the start of the beat to 0xFFFF at the end
+     */
+    uint16_t beatPhase() const
+    {
+        return m_phase >> (Shift - 16);
+    }
+
+    /**
+     * @brief beatInBar - Get the beat of the bar the clock is in
+     * @return 0 for the first beat of the bar
+     */
+    uint8_t beatInBar() const
+    {
+        return m_beatInBar;
+    }
+
+    /**
+     * @brief barPhase - Get how far through the current bar the clock is
+     * @return 0 at the start of the bar to 0xFFFF at the end
+     */
+    uint16_t barPhase() const
+    {
+        return (((uint32_t)m_beatInBar << 16) + beatPhase()) / m_beatsPerBar;
+    }
+
+    /**
+     * @brief subscribe - Adds a listener called when a beat or bar starts
+     * @param listener
+     * @return false if there is no room for another listener
+     */
+    bool subscribe(tempo_listener_t listener)
+    {
+        for(uint8_t i = 0; i < MaxListeners; i++) {
+            if(m_listeners[i] == listener)
+                return true;
+        }
+
+        for(uint8_t i = 0; i < MaxListeners; i++) {
+            if(m_listeners[i] == nullptr) {
+                m_listeners[i] = listener;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief unsubscribe - Removes a listener added by subscribe()
+     * @param listener
+     */
+    void unsubscribe(tempo_listener_t listener)
+    {
+        for(uint8_t i = 0; i < MaxListeners; i++) {
+            if(m_listeners[i] == listener)
+                m_listeners[i] = nullptr;
+        }
+    }
+
+};
+
+#endif // TEMPO_H
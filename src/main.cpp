@@ -21,14 +21,55 @@
 #define FASTLED_INTERNAL        // Suppress FastLED build banner
 #include <FastLED.h>            // FastLED Library
 #include <EEPROM.h>             // EEPROM library
+#include "config.h"             // Build configuration, selects the features below
 #include "ledgfx.h"             // LED "Graphics" helpers from DavePL
+#include "autotune.h"           // Frame rate tuning
+#if FEATURE_BOUNCING_BALL
 #include "bounce.h"             // Boouncing call effect
+#endif
+#if FEATURE_CLIPS || FEATURE_STREAM
+#include "clip.h"               // Pre-rendered clip decoder, also applies streamed delta frames
+#endif
+#if FEATURE_CLIPS
+#include "clips.h"              // Pre-rendered clips
+#endif
+#include "commands.h"           // Command codes, effect codes and the command table
+#if FEATURE_COMET
 #include "comet.h"              // Comet effect
+#endif
+#include "effectarena.h"        // Storage for the active effect objects
+#if FEATURE_FADE
+#include "fade.h"               // Long brightness and color fades
+#endif
+#if FEATURE_FIRE
 #include "fire.h"               // Fire effect
+#endif
+#if FEATURE_FIRE_COLOR
 #include "firewithcolor.h"      // Fire with color palette options
+#endif
+#if FEATURE_STREAM
+#include "interpolator.h"       // Streamed frame interpolation
+#endif
+#include "kernels.h"            // Whole frame buffer kernels
 #include "marquee.h"            // Marquee effect
 #include "protocol.h"           // Simple ASCII command protocol library
+#include "protostats.h"         // Command protocol counters
+#include "readback.h"           // Frame buffer readback
+#if FEATURE_RECORDER
+#include "recorder.h"           // Received packet recorder
+#endif
+#if FEATURE_RINGS
+#include "rings.h"              // Ring and fan geometry
+#endif
+#if FEATURE_EFFECT_STATES
+#include "statecache.h"         // Saved effect states for resuming effects
+#endif
+#if FEATURE_TEMPO
+#include "tempo.h"              // Beat clock for tempo synced effects
+#endif
+#if FEATURE_TWINKLE
 #include "twinkle.h"            // Twinkle effect
+#endif
 
 
 
@@ -41,374 +82,1428 @@ const char* VERSION_CODE = "LEDSC_TEENSY_001";
 
 
 
-#define NUM_LEDS                    300                     // FastLED definitions
 #define LED_PIN                     7                       // FastLED Data Pin
+#define MAX_POWER_VOLTS             5                       // LED power supply voltage
+#define MAX_POWER_MILLIAMPS         10000                   // LED power supply current limit
 
 #define MAX_BRIGHTNESS              255                     // Max brightness value
 #define MIN_BRIGHTNESS              0                       // Min brightness value
 #define MAX_INPUT_BUFFER_LEN        MAX_PROTO_PACKET_LEN    // Input buffer max length
+#define FIRE_WARM_START_FRAMES      8                       // Fire frames simulated over a seeded cold fire before it's shown
+#define MIN_FORCED_RENDER_INTERVAL_MS   5                   // Min time between renders forced by state changing commands
+#define MAX_PACKETS_PER_PASS        16                      // Max packets read per loop pass before rendering
+#define READBACK_CHUNK_CHARS        192                     // Max HEX characters in one frame readback chunk
+#define PACKET_RECORDER_SIZE        4096                    // Bytes kept for recording received packets
+#define STREAM_INTERPOLATED_FRAME_MS    10                  // Shortest Stream effect frame interval while interpolating
+#define STREAM_INTERPOLATED_MAX_FRAME_MS    33              // Longest Stream effect frame interval while interpolating
+#define FRAME_CPU_BUDGET_PCT        70                      // Share of each frame interval rendering and showing may use
+#define FADE_SHOW_INTERVAL_MS       16                      // Longest time between frames shown while fading, for dithering
 
 
 
 /* *
- * Command print version
+ * EEPROM Address locations for saved settings. Currently leaving extra space in the event a value
+ * increases in size in the future.
  * */
-#define CMD_PRINT_VERSION               "CPV\0"
+uint8_t ADDRESS_BRIGHTNESS = 0x0000;            // EEPROM address for brightnes 8bit value.
+uint16_t ADDRESS_EFFECT = 0x0002;               // EEPROM address for effect code value
+uint32_t ADDRESS_COLOR_RGB = 0x0004;            // EEPROM address for color value
+uint16_t ADDRESS_FIRE_COLOR_PALLET = 0x0008;    // EEPROM address for fire color pallet value
+uint16_t ADDRESS_CUSTOM_PALLET = 0x0010;        // EEPROM address for the 16 colors of the custom pallet
+uint16_t ADDRESS_CLIP = 0x0040;                 // EEPROM address for clip index
+uint16_t ADDRESS_STREAM_INTERPOLATION = 0x0041; // EEPROM address for stream interpolation mode
+uint16_t ADDRESS_LENGTH = 0x0042;               // EEPROM address for the strip length 16bit value
+uint16_t ADDRESS_TEMPO = 0x0044;                // EEPROM address for the tempo 16bit value, BPM * 100
+uint16_t ADDRESS_BEATS_PER_BAR = 0x0046;        // EEPROM address for beats per bar
+uint16_t ADDRESS_TEMPO_SYNC = 0x0047;           // EEPROM address for tempo sync
+uint16_t ADDRESS_RINGS = 0x0048;                // EEPROM address for the ring count then MAX_RINGS ring codes
 
 /* *
- * Command full reset - Reset the board - Not implemented
+ * Frame interval bounds in milliseconds
  * */
-#define  CMD_FULL_RESET                 "CFR\0"
+typedef struct frame_interval_struct
+{
+    uint16_t minMs;         // Shortest interval, the effect's designed speed when it moves per frame
+    uint16_t maxMs;         // Longest interval the tuner may slow the effect to
+} frame_interval_t;
 
 /* *
- * Command enter bootloader - Not implemented
+ * Frame interval bounds for each effect, indexed by Effect_t. The frame rate tuner picks the
+ * interval within them. Effects that move a step per frame are never run faster than designed.
  * */
-#define  CMD_ENTER_BOOTLOADER           "CEB\0"
+const frame_interval_t EFFECT_FRAME_INTERVAL_MS[AvailableEffects::MAX_EFFECT] =
+{
+    { 1000, 1000 },         // OFF
+    { 1000, 1000 },         // SOLID_COLOR
+    { 100,  200 },          // RAINBOW_CYCLE
+    { 16,   33 },           // COMET
+    { 16,   33 },           // COMET_RAINBOW
+    { 33,   50 },           // FIRE
+    { 10,   35 },           // FIRE_COLOR
+    { 33,   50 },           // SOLID_PULSE
+    { 8,    33 },           // BOUNCING_BALL, moves with the effect clock
+    { 16,   50 },           // TWINKLE
+    { 16,   16 },           // CLIP, replaced by the clip's own frame interval
+    { 1000, 1000 },         // STREAM, rendered when a frame is presented unless interpolating
+    { 16,   33 },           // SPINNER
+    { 16,   33 },           // RADAR
+    { 50,   100 },          // CLOCK
+};
+
+
+CRGB leds[MAX_LEDS] = {0};                                  // Frame buffer for FastLED
+uint16_t numLeds = MAX_LEDS;                                // Active strip length
+CLEDController* ledController = nullptr;                    // FastLED controller for the strip
+CRGB color(175,91,7);                                       // Base color for effects that require an input color
+uint8_t brightness = 0x44;                                  // 0-255 LED brightness
+int brightnessDelta = -10;                                  // Brightness delta
+int fps = 0;                                                // FastLED draw Frames per second
+byte hue = HUE_RED;                                         // Current hue for effects that use a base hue
+EffectArena<MaxValue<1                                      // Active effect object storage, sized for the largest built in
+#if FEATURE_BOUNCING_BALL
+    , sizeof(BouncingBallEffect)
+#endif
+#if FEATURE_COMET
+    , sizeof(Comet)
+#endif
+#if FEATURE_FIRE
+    , sizeof(FireEffect)
+#endif
+#if FEATURE_FIRE_COLOR
+    , sizeof(FireWithColor)
+#endif
+    >::value> effectArena;
+#if FEATURE_BOUNCING_BALL
+BouncingBallEffect* bouncingBall = nullptr;                 // Bouncing ball effect object, when active
+#endif
+#if FEATURE_COMET
+Comet* comet = nullptr;                                     // Comet effect object, when active
+#endif
+#if FEATURE_FIRE
+FireEffect* fire = nullptr;                                 // Fire effect object, when active
+#endif
+#if FEATURE_FIRE_COLOR
+FireWithColor* fireColor = nullptr;                         // Fire with color object, when active
+#endif
+#if FEATURE_EFFECT_STATES
+StateCache<EFFECT_STATE_CACHE_SIZE> effectStateCache;       // Saved states of inactive effects
+#endif
+Effect_t active_effect = AvailableEffects::OFF;             // Active LED Strip effect
+#if FEATURE_FIRE_COLOR
+FireColorPallets_t fireColorPallet = AvailableFireColorPallets::Heat;   // Current fire color pallet
+CRGBPalette16 customPallet(HeatColors_p);                   // Custom fire color pallet
+#endif
+#if FEATURE_READBACK
+FrameReadback<MAX_LEDS> frameReadback;                      // Frame readback in progress
+#endif
+#if FEATURE_RECORDER
+PacketRecorder<PACKET_RECORDER_SIZE> packetRecorder;        // Received packet recording
+#endif
+#if FEATURE_CLIPS
+ClipDecoder clipDecoder;                                    // Clip effect decoder
+uint8_t activeClip = 0;                                     // Clip played by the clip effect
+#endif
+#if FEATURE_STREAM
+CRGB streamFrame[MAX_LEDS] = {0};                           // Streamed frame being written
+bool streamPresented = false;                               // Stream frame ready to be shown
+FrameInterpolator<MAX_LEDS> streamInterpolator;             // Blends streamed frames while interpolating
+#endif
+bool debugging = false;                                     // Enable debugging output
+char char_in_buffer[MAX_INPUT_BUFFER_LEN];                  // Input character buffer
+proto_framer_t input_framer;                                // Frames char_in_buffer into packets
+proto_pkt_t pkt_receive;                                    // Command protocol receive packet
+proto_rsp_t pkt_response;                                   // Command protocol response packet
+uint32_t pktReceivedUs = 0;                                 // Time the last packet was received
+pending_cmd_t cmd_pending[COMMAND_COUNT];                   // Newest waiting packet for each coalesced command
+uint8_t cmd_pending_count = 0;                              // Number of waiting packets
+uint32_t cmd_pending_seq = 0;                               // Arrival order of the next queued packet
+ProtoStats<COMMAND_COUNT> protoStats;                       // Command protocol counters
+bool render_requested = false;                              // Visible state changed, show it on the next loop pass
+bool redraw_requested = false;                              // The change needs the effect drawn again to show
+uint32_t cmdReceivedUs = 0;                                 // Receipt time of the oldest command waiting for a render
+uint32_t cmdLatencyUs = 0;                                  // Last command receipt to show latency
+uint32_t cmdLatencyMaxUs = 0;                               // Max command receipt to show latency since last read
+uint32_t lastFrameMs = 0;                                   // Time the last frame was rendered
+uint32_t lastForcedRenderMs = 0;                            // Time the last forced frame was rendered
+uint32_t renderUs = 0;                                      // Time the last frame took to render
+uint32_t showUs = 0;                                        // Time the last frame took to show
+uint16_t framesToStep = 0;                                  // Frames left to render while frozen
+FrameRateTuner frameTuner(FRAME_CPU_BUDGET_PCT);            // Frame interval of the active effect
+#if FEATURE_TEMPO
+TempoClock tempo;                                           // Beat clock for tempo synced effects
+#endif
+bool tempoSync = false;                                     // Lock effects that follow the tempo to the beat
+bool beatRenderDue = false;                                 // A beat started, render it on the next loop pass
+#if FEATURE_RINGS
+RingGeometry<MAX_RINGS, MAX_LEDS> rings;                    // Rings the ring effects draw on
+uint32_t clockSeconds = 0;                                  // Time of day the clock was set to
+uint32_t clockSetMs = 0;                                    // Time the clock was set
+#endif
+#if FEATURE_FADE
+FadeChannel fadeBrightness;                                 // Brightness fade
+FadeChannel fadeColor[3];                                   // Color fade, per channel
+uint8_t fadeFrame = 0;                                      // Frames shown, picks each frame's dithering
+#endif
+uint32_t lastShowMs = 0;                                    // Time the last frame was shown
+uint16_t frameNumber = 0;                                   // Frames shown, wraps, tags readbacks and checksums
+
 
-/* *
- * Command set debugging
- * params
- * - debugging enabled in HEX:
- *       0x00 - off
- *       0x01 - on
- * */
-#define  CMD_SET_DEBUGGING              "CSD\0"
 
 /* *
- * Command Set Effect - Sets the active LED strip effect
- * params
- * - effect code in HEX:
- *      0x00 - Solid Color
- *      0x01 - Rainbow Cycle
- *      0x02 - Comet
- *      0x03 - Comet Rainbow
- *      0x04 - Fire
- *      0x05 - Fire with color
- *      0x06 - Solid Color Pulse
- *      0x07 - Bouncing Ball
- *      0x08 - Twinkle
+ * Fade all LEDS
  * */
-#define  CMD_SET_EFFECT                 "CSE\0"
+void fadeall() {
+    kernel_scale8((uint8_t*)leds, numLeds * 3, 250);
+}
+
+#if FEATURE_EFFECT_STATES
+
+/**
+ * @brief save_effect_state - Saves the state of an effect object to the effect state cache.
+ * @param effect - Effect code the state is saved under
+ * @param obj - Effect object, may be nullptr
+ */
+template<typename T>
+void save_effect_state(Effect_t effect, const T* obj) {
+
+    if(obj == nullptr) return;
+
+    uint8_t* state = effectStateCache.reserve(effect, obj->StateSize());
+    if(state != nullptr) obj->SaveState(state, obj->StateSize());
+}
+
+/**
+ * @brief load_effect_state - Restores the state of an effect object from the effect state cache.
+ * @param effect - Effect code the state was saved under
+ * @param obj - Effect object, may be nullptr
+ * @return true if a state was cached and restored.
+ */
+template<typename T>
+bool load_effect_state(Effect_t effect, T* obj) {
+
+    size_t len = 0;
+    const uint8_t* state = effectStateCache.find(effect, len);
+
+    return obj != nullptr && state != nullptr && obj->LoadState(state, len);
+}
+
+#endif // FEATURE_EFFECT_STATES
+
+/**
+ * @brief reset_frame_tuner - Retunes the frame interval from the active effect's bounds. Called
+ * whenever the effect, or how much work each of its frames does, changes.
+ */
+void reset_frame_tuner() {
+
+    frame_interval_t bounds = EFFECT_FRAME_INTERVAL_MS[active_effect < AvailableEffects::MAX_EFFECT ?
+                active_effect : AvailableEffects::OFF];
+
+#if FEATURE_CLIPS
+    if(active_effect == AvailableEffects::CLIP && clipDecoder.valid())
+        bounds.minMs = bounds.maxMs = clipDecoder.frameMs();
+#endif
+#if FEATURE_STREAM
+    if(active_effect == AvailableEffects::STREAM && streamInterpolator.mode() != INTERPOLATE_OFF) {
+        bounds.minMs = STREAM_INTERPOLATED_FRAME_MS;
+        bounds.maxMs = STREAM_INTERPOLATED_MAX_FRAME_MS;
+    }
+#endif
+
+    frameTuner.reset(bounds.minMs, bounds.maxMs);
+}
+
+/**
+ * @brief activate_effect - Makes the given effect active. Any effect object used by the previous
+ * effect is destroyed and the objects needed by the new effect are constructed in the effect arena.
+ * @param effect - Effect to activate
+ */
+void activate_effect(Effect_t effect) {
+
+    // Keep the outgoing effect's state so switching back resumes where it left off
+#if FEATURE_BOUNCING_BALL
+    save_effect_state(active_effect, bouncingBall);
+    bouncingBall = nullptr;
+#endif
+#if FEATURE_COMET
+    save_effect_state(active_effect, comet);
+    comet = nullptr;
+#endif
+#if FEATURE_FIRE
+    save_effect_state(active_effect, fire);
+    fire = nullptr;
+#endif
+#if FEATURE_FIRE_COLOR
+    save_effect_state(active_effect, fireColor);
+    fireColor = nullptr;
+#endif
+
+    effectArena.reset();
+
+    switch(effect)
+    {
+
+#if FEATURE_COMET
+    case AvailableEffects::COMET:
+    case AvailableEffects::COMET_RAINBOW:
+        comet = effectArena.create<Comet>(hue);
+        load_effect_state(effect, comet);
+        break;
+#endif
+
+#if FEATURE_FIRE
+    case AvailableEffects::FIRE:
+        fire = effectArena.create<FireEffect>(numLeds, 15, 100, 15, 4, true, true);
+        if(fire != nullptr && !load_effect_state(effect, fire))
+            fire->WarmStart(FIRE_WARM_START_FRAMES);
+        break;
+#endif
+
+#if FEATURE_FIRE_COLOR
+    case AvailableEffects::FIRE_COLOR:
+        fireColor = effectArena.create<FireWithColor>(numLeds);
+        if(fireColor != nullptr && !load_effect_state(effect, fireColor))
+            fireColor->WarmStart(FIRE_WARM_START_FRAMES);
+        break;
+#endif
+
+#if FEATURE_BOUNCING_BALL
+    case AvailableEffects::BOUNCING_BALL:
+        bouncingBall = effectArena.create<BouncingBallEffect>(numLeds);
+        load_effect_state(effect, bouncingBall);
+        break;
+#endif
+
+#if FEATURE_CLIPS
+    case AvailableEffects::CLIP:
+        clipDecoder.begin(CLIPS[activeClip].data, CLIPS[activeClip].size);
+        break;
+#endif
+
+#if FEATURE_STREAM
+    case AvailableEffects::STREAM:
+        streamInterpolator.reset();
+        break;
+#endif
+
+    default:
+        break;
+
+    };
+
+    active_effect = effect;
+    reset_frame_tuner();
+}
+
+/**
+ * @brief request_show - Requests the current frame is shown again on the next loop pass. Called by
+ * commands that change visible state applied as the frame is shown, like brightness, so they don't
+ * wait for the next effect frame.
+ */
+void request_show() {
+
+    if(!render_requested) cmdReceivedUs = pktReceivedUs;
+    render_requested = true;
+}
+
+/**
+ * @brief request_render - Requests the active effect is drawn and shown on the next loop pass.
+ * Called by commands that change what the effect draws, like a new effect or strip length. Effects
+ * that step on each frame drawn take an extra step, so it is kept to changes that need it.
+ */
+void request_render() {
+
+    request_show();
+    redraw_requested = true;
+}
+
+/**
+ * @brief request_color_render - Requests a color change is shown. Solid Color is drawn from the
+ * color so it's drawn again, other effects pick it up on their next frame.
+ */
+void request_color_render() {
+
+    if(active_effect == AvailableEffects::SOLID_COLOR) request_render();
+    else request_show();
+}
+
+/**
+ * @brief set_strip_length - Changes the number of LEDs rendered and shown. The active effect is
+ * recreated for the new length and saved effect states, which are sized for the old one, are
+ * dropped.
+ * @param length - Number of LEDs, MIN_LEDS to MAX_LEDS
+ */
+void set_strip_length(uint16_t length) {
+
+    Effect_t effect = active_effect;
+
+    // Blank the old length first, LEDs past a shorter length are no longer written
+    FastLED.clear(true);
+
+    activate_effect(AvailableEffects::OFF);
+#if FEATURE_EFFECT_STATES
+    effectStateCache.clear();
+#endif
+
+    numLeds = length;
+    ledController->setLeds(leds, numLeds);
+
+    activate_effect(effect);
+    request_render();
+}
+
+/**
+ * @brief tempo_synced - Get whether an effect is locked to the beat
+ * @param effect
+ * @return true if tempo sync is on and the effect follows the tempo
+ */
+bool tempo_synced(Effect_t effect) {
+
+    if(!FEATURE_TEMPO || !tempoSync) return false;
+
+    switch(effect)
+    {
+    case AvailableEffects::RAINBOW_CYCLE:
+    case AvailableEffects::COMET:
+    case AvailableEffects::COMET_RAINBOW:
+    case AvailableEffects::SOLID_PULSE:
+    case AvailableEffects::SPINNER:
+    case AvailableEffects::RADAR:
+        return true;
+
+    default:
+        return false;
+    };
+}
+
+#if FEATURE_RINGS
+
+/**
+ * @brief set_rings - Replaces the ring geometry
+ * @param codes - Ring codes from Set Rings, 0xSSOOFFRR, each valid
+ * @param count - Number of rings
+ */
+void set_rings(const uint32_t* codes, uint8_t count) {
+
+    rings.clear();
+    for(uint8_t i = 0; i < count; i++)
+        rings.addRing(codes[i] >> 24, codes[i] >> 16, codes[i] >> 8, codes[i]);
+}
+
+/**
+ * @brief set_default_rings - Sets the ring geometry to the fans ledgfx.h describes
+ */
+void set_default_rings() {
+
+    rings.clear();
+    for(uint8_t i = 0; i < NUM_FANS; i++)
+        rings.addRing(FAN_SIZE, LED_FAN_OFFSET, 0, 255);
+}
+
+#endif // FEATURE_RINGS
+
+#if FEATURE_TEMPO
+
+/**
+ * @brief on_tempo_event - Tempo listener, renders each beat as it starts rather than on the next
+ * frame the effect's interval allows
+ * @param events
+ * @param beat
+ */
+void on_tempo_event(uint8_t events, uint16_t beat) {
+
+    if(tempo_synced(active_effect)) beatRenderDue = true;
+}
+
+#endif // FEATURE_TEMPO
+
+/**
+ * @brief proc_print_error
+ * @param pkt_received
+ * @param pkt_response
+ * @param errorcode
+ */
+void proc_print_error(const proto_pkt_t* pkt_received, proto_rsp_t* pkt_response, int16_t errorcode) {
+    proto_init_response_pkt(pkt_response, pkt_received);
+    proto_set_response_pkt_error_code(pkt_response, errorcode);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_not_implemented - Handler for commands that are not implemented
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_not_implemented(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_CMD_NOT_IMP);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_print_version
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_print_version(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, VERSION_CODE);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_debugging
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_debugging(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    if(argc > 0)
+        debugging = args[0].u32 != 0;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_active_effect
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_active_effect(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint8_t effectin = args[0].u8;
+
+    if(effect_available(effectin)) {
+        if(effectin != active_effect) activate_effect((AvailableEffects)effectin);
+        EEPROM.put(ADDRESS_EFFECT, (uint16_t)effectin);
+        request_render();
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_color
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_color(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint32_t colorin = args[0].u32;
+    color.setColorCode(colorin);
+#if FEATURE_FADE
+    for(uint8_t c = 0; c < 3; c++) fadeColor[c].set(color[c]);
+#endif
+    EEPROM.put(ADDRESS_COLOR_RGB, colorin);
+    request_color_render();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_brightness
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_brightness(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    brightness = args[0].u8;
+#if FEATURE_FADE
+    fadeBrightness.set(brightness);
+#endif
+    FastLED.setBrightness(brightness);
+    EEPROM.put(ADDRESS_BRIGHTNESS, brightness);
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#if FEATURE_FIRE_COLOR
+
+/**
+ * @brief proc_set_fire_color_pallet
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_fire_color_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    fireColorPallet = (FireColorPallets_t)args[0].u8;
+    EEPROM.put(ADDRESS_FIRE_COLOR_PALLET, (uint16_t)fireColorPallet);
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_custom_pallet
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_custom_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    for(uint8_t i=0; i<16; i++)
+        customPallet[i] = CRGB(args[i * argc / 16].u32);
+
+    EEPROM.put(ADDRESS_CUSTOM_PALLET, customPallet.entries);
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#endif // FEATURE_FIRE_COLOR
+
+/**
+ * @brief proc_get_status processes the get status command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_get_status(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+#if FEATURE_FIRE_COLOR
+    uint16_t pallet = fireColorPallet;
+#else
+    uint16_t pallet = 0;
+#endif
+
+    sprintf(buff,
+            "%02X|%02X|%02X|%02X%02X%02X|%02X|%04X",
+            debugging,
+            (uint16_t)active_effect,
+            brightness,
+            color.r, color.g, color.b,
+            pallet,
+            numLeds);
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_SUCCESS);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief readback_scale - Gets the per channel scale for a frame readback source
+ * @param source
+ * @return
+ */
+CRGB readback_scale(uint8_t source) {
+
+    if(source != AvailableReadbackSources::FrameOutput) return CRGB(255, 255, 255);
+
+    uint8_t scale = calculate_max_brightness_for_power_mW(FastLED.getBrightness(),
+                                                          MAX_POWER_VOLTS * MAX_POWER_MILLIAMPS);
+    return FastLED[0].getAdjustment(scale);
+}
+
+#if FEATURE_READBACK
+
+/**
+ * @brief proc_get_frame processes the get frame command. Only starts the readback, the chunks
+ * are sent by proc_frame_readback_chunk().
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_get_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    uint8_t source = argc > 0 ? args[0].u8 : (uint8_t)AvailableReadbackSources::FrameBuffer;
+    uint8_t encoding = argc > 1 ? args[1].u8 : (uint8_t)AvailableReadbackEncodings::RleRGB888;
+    uint8_t downsample = argc > 2 ? args[2].u8 : 1;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(source >= AvailableReadbackSources::MaxReadbackSource
+            || encoding >= AvailableReadbackEncodings::MaxReadbackEncoding
+            || downsample == 0) {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    frameReadback.begin(leds, numLeds, (ReadbackEncoding_t)encoding, downsample, readback_scale(source));
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    sprintf(buff, "%04X|%04X", frameReadback.pixelCount(), frameNumber);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_frame_readback_chunk - Sends the next chunk of the frame readback in progress.
+ */
+void proc_frame_readback_chunk() {
+
+    static char chunk[READBACK_CHUNK_CHARS];
+    uint16_t firstPixel = 0;
+    uint16_t len = frameReadback.nextChunk(chunk, READBACK_CHUNK_CHARS, &firstPixel);
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    sprintf(buff, "%04X", firstPixel);
+
+    proto_init_response_pkt(&pkt_response, CMD_GET_FRAME);
+    proto_append_response_pkt_param(&pkt_response, buff);
+    proto_set_response_pkt_payload(&pkt_response, chunk, len);
+    proto_print_response_pkt(&pkt_response);
+}
+
+#endif // FEATURE_READBACK
+
+/**
+ * @brief proc_get_frame_checksum processes the get frame checksum command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_get_frame_checksum(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    uint8_t source = argc > 0 ? args[0].u8 : (uint8_t)AvailableReadbackSources::FrameBuffer;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(source >= AvailableReadbackSources::MaxReadbackSource) {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    sprintf(buff, "%04X|%04X|%04X", frame_checksum(leds, numLeds, readback_scale(source)), numLeds, frameNumber);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_get_telemetry processes the get telemetry command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_get_telemetry(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    sprintf(buff,
+            "%08lX|%08lX|%04X|%08lX|%08lX|%04X",
+            (unsigned long)cmdLatencyUs,
+            (unsigned long)cmdLatencyMaxUs,
+            FastLED.getFPS(),
+            (unsigned long)renderUs,
+            (unsigned long)showUs,
+            frameTuner.intervalMs());
+
+    cmdLatencyMaxUs = 0;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_SUCCESS);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_freeze processes the freeze command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_freeze(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    FreezeEffectClock(args[0].u8 != 0);
+    framesToStep = 0;
+
+    if(argc > 1) {
+        randomSeed(args[1].u32);
+        random16_set_seed(args[1].u32);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_frame_step processes the frame step command. The frames are rendered by the loop,
+ * one per pass.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_frame_step(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    FreezeEffectClock(true);
+    framesToStep = argc > 0 ? args[0].u16 : 1;
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#if FEATURE_RECORDER
+
+/**
+ * @brief proc_set_recording processes the set recording command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8) packetRecorder.start(micros());
+    else packetRecorder.stop();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_get_recording processes the get recording command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_get_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(argc == 0) {
+
+        sprintf(buff,
+                "%04X|%04X|%02X",
+                packetRecorder.count(),
+                packetRecorder.dropped(),
+                packetRecorder.recording());
+
+        proto_append_response_pkt_param(pkt_response, buff);
+
+    } else {
+
+        uint32_t timeUs;
+        uint16_t len;
+        const char* body = packetRecorder.get(args[0].u16, &timeUs, &len);
+
+        if(body != nullptr) {
+            sprintf(buff, "%08lX", (unsigned long)timeUs);
+            proto_append_response_pkt_param(pkt_response, buff);
+            proto_set_response_pkt_payload(pkt_response, body, len);
+        } else {
+            proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        }
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#endif // FEATURE_RECORDER
+
+#if FEATURE_CLIPS
+
+/**
+ * @brief proc_set_clip processes the set clip command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_clip(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8 < CLIP_COUNT) {
+
+        activeClip = args[0].u8;
+        EEPROM.put(ADDRESS_CLIP, activeClip);
+
+        if(active_effect == AvailableEffects::CLIP) {
+            clipDecoder.begin(CLIPS[activeClip].data, CLIPS[activeClip].size);
+            reset_frame_tuner();
+            request_render();
+        }
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#endif // FEATURE_CLIPS
+
+#if FEATURE_STREAM
+
+/**
+ * @brief proc_write_frame processes the write frame command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_write_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint16_t first = args[0].u16;
+    uint8_t flags = args[1].u8;
+    const char* hex = argc > 2 ? pkt_receive.buffer + args[2].slice.offset : nullptr;
+    uint16_t hexLen = argc > 2 ? args[2].slice.len : 0;
+    int16_t error_code = ERR_PROTO_SUCCESS;
+
+    if(first > numLeds) {
+
+        error_code = ERR_PROTO_CP_PARAM_OUT_RANGE;
+
+    } else if(flags & WRITE_FRAME_DELTA) {
+
+        // Ops are at most half the packet, decoded from HEX on the stack
+        uint8_t ops[MAX_PROTO_PACKET_LEN / 2];
+        uint16_t len = hexLen / 2;
+        uint32_t value;
+
+        for(uint16_t i=0; i<len && error_code == ERR_PROTO_SUCCESS; i++) {
+            error_code = proto_parse_hex(hex + i * 2, 2, 0xFF, &value);
+            if(error_code == ERR_PROTO_SUCCESS) ops[i] = value;
+        }
+
+        if(error_code == ERR_PROTO_SUCCESS
+                && (hexLen % 2 != 0 || ClipDecoder::applyOps(ops, len, (uint8_t*)streamFrame, first, numLeds) < 0))
+            error_code = ERR_PROTO_CP_PARAM_INVALID;
+
+    } else {
+
+        uint16_t count = hexLen / 6;
+        uint32_t value;
+
+        if(hexLen % 6 != 0) error_code = ERR_PROTO_CP_PARAM_INVALID;
+        else if(first + count > numLeds) error_code = ERR_PROTO_CP_PARAM_OUT_RANGE;
+
+        for(uint16_t i=0; i<count && error_code == ERR_PROTO_SUCCESS; i++) {
+            error_code = proto_parse_hex(hex + i * 6, 6, 0xFFFFFF, &value);
+            if(error_code == ERR_PROTO_SUCCESS) streamFrame[first + i].setColorCode(value);
+        }
+    }
+
+    if(error_code != ERR_PROTO_SUCCESS) {
+        proto_set_response_pkt_error_code(pkt_response, error_code);
+    } else if(flags & WRITE_FRAME_PRESENT) {
+
+        if(active_effect == AvailableEffects::STREAM && streamInterpolator.mode() != INTERPOLATE_OFF) {
+            // Blend from the frame being shown, the segment starts now rather than at the next render
+            streamInterpolator.present((uint8_t*)leds, (uint8_t*)streamFrame, numLeds, EffectClockMs(),
+                                       argc > 3, argc > 3 ? args[3].u32 : 0);
+        } else {
+            streamPresented = true;
+        }
+
+        if(active_effect == AvailableEffects::STREAM) request_render();
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_set_interpolation processes the set stream interpolation command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_interpolation(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8 < INTERPOLATE_MODES) {
+
+        streamInterpolator.setMode(args[0].u8);
+        EEPROM.put(ADDRESS_STREAM_INTERPOLATION, args[0].u8);
+
+        if(active_effect == AvailableEffects::STREAM) reset_frame_tuner();
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+#endif // FEATURE_STREAM
+
+/**
+ * @brief proc_set_length processes the set length command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_length(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u16 >= MIN_LEDS && args[0].u16 <= MAX_LEDS) {
+
+        if(args[0].u16 != numLeds) set_strip_length(args[0].u16);
+        EEPROM.put(ADDRESS_LENGTH, numLeds);
 
-/* *
- * Command Set Color - Sets the base color for effects that use an input color
- * params
- * - Color code 24bit RGB in HEX
- * */
-#define CMD_SET_COLOR                   "CSC\0"
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
 
-/* *
- * Command Set Brightness - Sets the brightness
- * params
- * - Brightness 0-255 in HEX
- * */
-#define CMD_SET_BRIGHTNESS              "CSB\0"
+    proto_print_response_pkt(pkt_response);
+}
 
-/* *
- * Command Set Fire Color Pallet - Sets the active color pallet for FIRE_COLOR effect
- * params
- * - Pallet code in HEX:
- *      0x00 - Heat
- *      0x01 - Party
- *      0x02 - Rainbow
- *      0x03 - RainbowStripe
- *      0x04 - Forest
- *      0x05 - Ocean
- *      0x06 - Lava
- *      0x07 - Cloud
- * */
-#define CMD_SET_FIRE_COLOR_PALLET       "CSFP\0"
+#if FEATURE_TEMPO
 
-/* *
- * Command Get Status - Gets the status of the LED Strip parameters
- * */
-#define CMD_GET_STATUS                  "CGS\0"
+/**
+ * @brief proc_set_tempo processes the set tempo command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
+ */
+void proc_set_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
 
+    proto_init_response_pkt(pkt_response, cmd->name);
 
-/* *
- * EEPROM Address locations for saved settings. Currently leaving extra space in the event a value
- * increases in size in the future.
- * */
-uint8_t ADDRESS_BRIGHTNESS = 0x0000;            // EEPROM address for brightnes 8bit value.
-uint16_t ADDRESS_EFFECT = 0x0002;               // EEPROM address for effect code value
-uint32_t ADDRESS_COLOR_RGB = 0x0004;            // EEPROM address for color value
-uint16_t ADDRESS_FIRE_COLOR_PALLET = 0x0008;    // EEPROM address for fire color pallet value
+    uint8_t beatsPerBar = argc > 2 ? args[2].u8 : tempo.beatsPerBar();
 
-/* *
- * LED Strip effects
- * */
-typedef enum AvailableEffects
-{
-    OFF = 0x00,             // Off
-    SOLID_COLOR,            // Solid color
-    RAINBOW_CYCLE,          // Rainbow cycle
-    COMET,                  // Comet with static color
-    COMET_RAINBOW,          // Comet rainbow
-    FIRE,                   // Classic fire effect
-    FIRE_COLOR,             // Fire with color effect
-    SOLID_PULSE,            // Solid color pulse
-    BOUNCING_BALL,          // Bouncing ball
-    TWINKLE,                // Twinkle
-    MAX_EFFECT,             // Easy reference to the number of effects
-} Effect_t;
-
-
-CRGB leds[NUM_LEDS] = {0};                                  // Frame buffer for FastLED
-CRGB color(175,91,7);                                       // Base color for effects that require an input color
-uint8_t brightness = 0x44;                                  // 0-255 LED brightness
-int brightnessDelta = -10;                                  // Brightness delta
-int fps = 0;                                                // FastLED draw Frames per second
-byte hue = HUE_RED;                                         // Current hue for effects that use a base hue
-BouncingBallEffect bouncingBall(NUM_LEDS);                  // Bouncing ball effect object
-Comet comet(hue);                                           // Comet effect object
-FireEffect fire(NUM_LEDS, 15, 100, 15, 4, true, true);      // Fire effect object
-FireWithColor fireColor(NUM_LEDS);                          // Fire with color object
-Effect_t active_effect = AvailableEffects::OFF;             // Active LED Strip effect
-FireColorPallets_t fireColorPallet = AvailableFireColorPallets::Heat;   // Current fire color pallet
-bool debugging = false;                                     // Enable debugging output
-uint16_t cib_len=0;                                         // Current input buffer length
-char ich = 0;                                               // Current input buffer character index
-char char_in_buffer[MAX_PROTO_PACKET_LEN];                  // Input character buffer
-proto_pkt_t pkt_receive;                                    // Command protocol receive packet
-proto_pkt_t pkt_response;                                   // Command protocol response packet
+    if(args[0].u16 >= TEMPO_MIN_BPM && args[0].u16 <= TEMPO_MAX_BPM
+            && beatsPerBar > 0 && beatsPerBar <= TEMPO_MAX_BEATS_PER_BAR) {
 
+        tempo.update(EffectClockMs());
+        tempo.setBpm(args[0].u16);
+        tempo.setBeatsPerBar(beatsPerBar);
+        if(argc > 1) tempo.setPhase(args[1].u16, EffectClockMs());
 
+        EEPROM.put(ADDRESS_TEMPO, tempo.bpm());
+        EEPROM.put(ADDRESS_BEATS_PER_BAR, tempo.beatsPerBar());
 
-/* *
- * Fade all LEDS
- * */
-void fadeall() {
-    for(int i = 0; i < NUM_LEDS; i++) {
-        leds[i].nscale8(250);
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
     }
+
+    proto_print_response_pkt(pkt_response);
 }
 
 /**
- * @brief proc_print_error
- * @param pkt
+ * @brief proc_tap_tempo processes the tap tempo command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_print_error(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response, int16_t errorcode) {
-    proto_init_response_pkt(pkt_response, pkt_received);
-    proto_set_response_pkt_error_code(pkt_response, errorcode);
+void proc_tap_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    if(tempo.tap(EffectClockMs())) EEPROM.put(ADDRESS_TEMPO, tempo.bpm());
+
+    // The tap lands on a beat, show it now
+    if(tempo_synced(active_effect)) request_render();
+
+    sprintf(buff, "%04X", tempo.bpm());
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_SUCCESS);
     proto_print_response_pkt(pkt_response);
 }
 
 /**
- * @brief proc_print_version
- * @param pkt
+ * @brief proc_set_tempo_sync processes the set tempo sync command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_print_version(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
-    proto_init_response_pkt(pkt_response, pkt_received);
-    proto_append_response_pkt_param(pkt_response, VERSION_CODE);
+void proc_set_tempo_sync(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    tempoSync = args[0].u8 != 0;
+    EEPROM.put(ADDRESS_TEMPO_SYNC, (uint8_t)tempoSync);
+    request_render();
+
     proto_print_response_pkt(pkt_response);
 }
 
 /**
- * @brief proc_set_debugging
- * @param pkt
+ * @brief proc_get_tempo processes the get tempo command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_set_debugging(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+void proc_get_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
 
-    if(pkt_received->param_count > 0)
-        debugging = atoi(pkt_received->params[0]) != 0;
+    tempo.update(EffectClockMs());
 
-    proto_init_response_pkt(pkt_response, pkt_received);
+    sprintf(buff,
+            "%04X|%02X|%04X|%02X|%04X|%02X",
+            tempo.bpm(),
+            tempo.beatsPerBar(),
+            tempo.beat(),
+            tempo.beatInBar(),
+            tempo.beatPhase(),
+            tempoSync);
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_SUCCESS);
     proto_print_response_pkt(pkt_response);
 }
 
+#endif // FEATURE_TEMPO
+
+#if FEATURE_RINGS
+
 /**
- * @brief proc_set_active_effect
- * @param pkt
+ * @brief proc_set_rings processes the set rings command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_set_active_effect(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+void proc_set_rings(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
 
-    proto_init_response_pkt(pkt_response, pkt_received);
+    proto_init_response_pkt(pkt_response, cmd->name);
 
-    if(pkt_received->param_count <= 0) {
-        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_MISSING_PARAMS);
-        proto_print_response_pkt(pkt_response);
-        return;
+    uint32_t codes[MAX_RINGS];
+    uint16_t total = 0;
+    bool valid = argc <= MAX_RINGS;
+
+    for(uint8_t i = 0; valid && i < argc; i++) {
+        codes[i] = args[i].u32;
+        total += codes[i] >> 24;
+        valid = ring_code_valid(codes[i]) && total <= MAX_LEDS;
     }
 
-    if(pkt_received->param_count > 0) {
-        long effectin = strtol(pkt_received->params[0], NULL, 16);
+    if(valid) {
 
-        if(effectin >= 0 && effectin < AvailableEffects::MAX_EFFECT) {
-            active_effect = (AvailableEffects)effectin;
-            EEPROM.put(ADDRESS_EFFECT, (uint16_t)effectin);
-        }
-    }
+        set_rings(codes, argc);
+
+        EEPROM.put(ADDRESS_RINGS, argc);
+        for(uint8_t i = 0; i < argc; i++) EEPROM.put(ADDRESS_RINGS + 1 + i * sizeof(uint32_t), codes[i]);
 
+        request_render();
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
 
     proto_print_response_pkt(pkt_response);
 }
 
 /**
- * @brief proc_set_color
- * @param pkt
+ * @brief proc_set_time processes the set time command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_set_color(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+void proc_set_time(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
 
-    proto_init_response_pkt(pkt_response, pkt_received);
+    proto_init_response_pkt(pkt_response, cmd->name);
 
-    if(pkt_received->param_count <= 0) {
-        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_MISSING_PARAMS);
-        proto_print_response_pkt(pkt_response);
-        return;
-    }
+    if(args[0].u32 < SECONDS_PER_DAY) {
 
-    if(pkt_received->param_count > 0) {
-        uint32_t colorin = strtol(pkt_received->params[0], NULL, 16);
-        color.setColorCode(colorin);
-        EEPROM.put(ADDRESS_COLOR_RGB, colorin);
-    }
+        clockSeconds = args[0].u32;
+        clockSetMs = millis();
+        if(active_effect == AvailableEffects::CLOCK) request_render();
 
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
 
     proto_print_response_pkt(pkt_response);
 }
 
+#endif // FEATURE_RINGS
+
+#if FEATURE_FADE
+
 /**
- * @brief proc_set_brightness
- * @param pkt
+ * @brief proc_fade processes the fade command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_set_brightness(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+void proc_fade(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
 
-    proto_init_response_pkt(pkt_response, pkt_received);
+    proto_init_response_pkt(pkt_response, cmd->name);
 
-    if(pkt_received->param_count <= 0) {
-        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_MISSING_PARAMS);
-        proto_print_response_pkt(pkt_response);
-        return;
-    }
+    if(args[0].u32 <= FADE_MAX_MS) {
 
-    if(pkt_received->param_count > 0) {
-        brightness = strtol(pkt_received->params[0], NULL, 16);
-        FastLED.setBrightness(brightness);
-        EEPROM.put(ADDRESS_BRIGHTNESS, brightness);
+        uint32_t now = EffectClockMs();
+
+        // Start from what's shown, Solid Pulse sets the brightness without fading
+        if(!fadeBrightness.active()) fadeBrightness.set(brightness);
+        fadeBrightness.start(args[1].u8, args[0].u32, now);
+
+        if(argc > 2) {
+            CRGB target(args[2].u32);
+            for(uint8_t c = 0; c < 3; c++) fadeColor[c].start(target[c], args[0].u32, now);
+        }
+
+        request_color_render();
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
     }
 
     proto_print_response_pkt(pkt_response);
 }
 
+#endif // FEATURE_FADE
+
 /**
- * @brief proc_set_fire_color_pallet
- * @param pkt
+ * @brief proc_get_proto_stats processes the get protocol stats command.
+ * @param cmd
+ * @param args
+ * @param argc
+ * @param pkt_response
  */
-void proc_set_fire_color_pallet(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+void proc_get_proto_stats(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
 
-    proto_init_response_pkt(pkt_response, pkt_received);
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(argc == 0) {
+
+        sprintf(buff,
+                "%08lX|%08lX|%08lX|%08lX|%08lX",
+                (unsigned long)protoStats.bytes(),
+                (unsigned long)protoStats.packets(),
+                (unsigned long)protoStats.overflows(),
+                (unsigned long)protoStats.errors(ERR_PROTO_CP_CRC16_MISMATCH),
+                (unsigned long)input_framer.wasted);
+        proto_append_response_pkt_param(pkt_response, buff);
+
+        // Too long for a param, the error counts go in the payload
+        static char errors[PROTO_STATS_ERROR_COUNT * 9];
+        uint16_t len = 0;
+        for(int16_t code = PROTO_STATS_FIRST_ERROR; code >= PROTO_STATS_LAST_ERROR; code--)
+            len += sprintf(errors + len, len > 0 ? "|%08lX" : "%08lX", (unsigned long)protoStats.errors(code));
+        proto_set_response_pkt_payload(pkt_response, errors, len);
 
-    if(pkt_received->param_count <= 0) {
-        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_MISSING_PARAMS);
         proto_print_response_pkt(pkt_response);
         return;
     }
 
-    if(pkt_received->param_count > 0) {
-        fireColorPallet = (FireColorPallets_t)strtol(pkt_received->params[0], NULL, 16);
-        EEPROM.put(ADDRESS_FIRE_COLOR_PALLET, (uint16_t)fireColorPallet);
+    const char* name = pkt_receive.buffer + args[0].slice.offset;
+    uint16_t len = args[0].slice.len;
+
+    for(uint8_t i = 0; i < COMMAND_COUNT; i++) {
+
+        if(strlen(COMMANDS[i].name) != len || strncmp(COMMANDS[i].name, name, len) != 0) continue;
+
+        const proto_cmd_stats_t& stats = protoStats.commandStats(i);
+        sprintf(buff,
+                "%08lX|%08lX|%08lX",
+                (unsigned long)stats.count,
+                (unsigned long)stats.handlerUs,
+                (unsigned long)stats.handlerMaxUs);
+        proto_append_response_pkt_param(pkt_response, buff);
+        proto_print_response_pkt(pkt_response);
+        return;
     }
 
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
     proto_print_response_pkt(pkt_response);
 }
 
 /**
- * @brief proc_get_status processes the get status command.
- * @param pkt_received
- * @param pkt_response
+ * @brief proc_input Processes incoming serial data and writes it to pkt_receive. The packet refers
+ * to char_in_buffer and is only valid until the next call. After noise, a lost CR or an overflow
+ * the framer picks up again at the next STX, and the dropped packet is answered with an error.
+ * @return Packet length when end of packet detected. 0 When packet has been cleared due to no data.
  */
-void proc_get_status(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
+int16_t proc_input(proto_pkt_t* pkt_received) {
 
-    char buff[MAX_PROTO_PARAM_LEN];
+    if(!Serial) return 0;
 
-    sprintf(buff,
-            "%02X|%02X|%02X|%02X%02X%02X|%02X",
-            debugging,
-            (uint16_t)active_effect,
-            brightness,
-            color.r, color.g, color.b,
-            (uint16_t)fireColorPallet);
+    uint32_t bytes = 0;
 
-    proto_init_response_pkt(pkt_response, pkt_received);
-    proto_append_response_pkt_param(pkt_response, buff);
-    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_SUCCESS);
-    proto_print_response_pkt(pkt_response);
+    while(Serial.available() > 0) {
+
+        int16_t error_code = proto_frame_char(&input_framer, (char)Serial.read());
+        bytes++;
+
+        if(error_code == PROTO_FRAME_LINE) {
+            pktReceivedUs = micros();
+            error_code = proto_parse_pkt_buffer(input_framer.buffer, input_framer.line_len, pkt_received);
+            protoStats.packet();
+
+            if(error_code > 0) {
+                protoStats.received(bytes);
+                return error_code;
+            }
+        } else if(error_code < 0) {
+            // The framer threw the packet away and is already receiving the next one
+            proto_clear_pkt(pkt_received);
+            if(error_code == ERR_PROTO_CP_CMD_OVERFLOW) protoStats.overflow();
+        }
+
+        if(error_code < 0) {
+            protoStats.error(error_code);
+            proc_print_error(pkt_received, &pkt_response, error_code);
+        }
+    }
+
+    protoStats.received(bytes);
+
+    return 0;
 }
 
 /**
- * @brief proc_input Processes incoming serial data and writes it to pkt_receive
- * @return Packet length when end of packet detected. 0 When packet has been cleared due to no data.
+ * @brief proc_run_cmd - Calls a command's handler, counting the time it takes and any error it
+ * responds with.
+ * @param cmd - Command table entry
+ * @param args - Typed params
+ * @param argc - Number of params
  */
-uint8_t proc_input(proto_pkt_t* pkt_received) {
+void proc_run_cmd(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc) {
 
-    if(!Serial) return 0;
+    uint32_t start = micros();
 
-    while(Serial.available() > 0) {
+    pkt_response.error_code = ERR_PROTO_SUCCESS;
+    cmd->handler(cmd, args, argc, &pkt_response);
 
-        ich = (char)Serial.read();
+    protoStats.handled(cmd - COMMANDS, micros() - start);
+    protoStats.error(pkt_response.error_code);
+}
 
-        //ignore \r and \n
-        if(cib_len < MAX_INPUT_BUFFER_LEN && ich != PROTO_CR && ich != PROTO_NL)
-            char_in_buffer[cib_len++] = ich;
+/**
+ * @brief proc_pending_cmds - Applies all queued coalesced commands in the order they arrived, so
+ * acks go out in that order and later setters win where they overlap.
+ */
+void proc_pending_cmds() {
 
-        if(ich == PROTO_CR) {
-            int16_t error_code = proto_parse_pkt_buffer(char_in_buffer, cib_len, pkt_received);
-            memset(char_in_buffer, 0, MAX_INPUT_BUFFER_LEN);
-            cib_len = 0;
+    while(cmd_pending_count > 0) {
 
-            if(error_code >= 0) {
-                return error_code;
-            } else {
-                proto_init_response_pkt(&pkt_response, pkt_received);
-                proto_set_response_pkt_error_code(&pkt_response, error_code);
-                proto_print_response_pkt(&pkt_response);
-            }
+        // Only a few are ever waiting, so the oldest is found with a scan. Sequence numbers wrap.
+        uint8_t oldest = COMMAND_COUNT;
+        for(uint8_t i=0; i<COMMAND_COUNT; i++) {
+            if(cmd_pending[i].pending && (oldest == COMMAND_COUNT || cmd_pending[i].seq - cmd_pending[oldest].seq >= 0x80000000))
+                oldest = i;
         }
+
+        pending_cmd_t* pending = &cmd_pending[oldest];
+        pending->pending = false;
+        cmd_pending_count--;
+        pktReceivedUs = pending->receivedUs;
+        proc_run_cmd(&COMMANDS[oldest], pending->args, pending->argc);
     }
+}
+
+/**
+ * @brief proc_queue_cmd - Queues a coalesced command to be applied later. A command already
+ * waiting is superseded and acknowledged as coalesced.
+ * @param cmd - Command table entry
+ * @param args - Typed params
+ * @param argc - Number of params
+ */
+void proc_queue_cmd(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc) {
 
-    //reset do to buffer overflow
-    if(cib_len >= MAX_INPUT_BUFFER_LEN) {
-        proto_init_response_pkt(&pkt_response, pkt_received);
-        proto_set_response_pkt_error_code(&pkt_response, ERR_PROTO_CP_CMD_OVERFLOW);
+    pending_cmd_t* pending = &cmd_pending[cmd - COMMANDS];
+
+    if(pending->pending) {
+        proto_init_response_pkt(&pkt_response, cmd->name);
+        proto_set_response_pkt_error_code(&pkt_response, ERR_PROTO_COALESCED);
         proto_print_response_pkt(&pkt_response);
-        memset(char_in_buffer, 0, MAX_INPUT_BUFFER_LEN);
-        cib_len = 0;
+    } else {
+        pending->pending = true;
+        cmd_pending_count++;
     }
 
-    return 0;
+    memcpy(pending->args, args, argc * sizeof(proto_arg_t));
+    pending->argc = argc;
+    pending->receivedUs = pktReceivedUs;
+    pending->seq = cmd_pending_seq++;
 }
 
 /**
- *
+ * @brief proc_cmd - Looks up a received packet's command, parses its params and either queues it
+ * (coalesced commands) or calls its handler.
  * @param pkt_received
- * @param pkt_response
  */
-void proc_cmd(proto_pkt_t* pkt_received, proto_pkt_t* pkt_response) {
-
-    if(strcmp(pkt_received->cmd, CMD_PRINT_VERSION) == 0) {
-        proc_print_version(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_FULL_RESET) == 0) {
-        proc_print_error(pkt_received, pkt_response, ERR_PROTO_CP_CMD_NOT_IMP);
-    } else if(strcmp(pkt_received->cmd, CMD_ENTER_BOOTLOADER) == 0) {
-        proc_print_error(pkt_received, pkt_response, ERR_PROTO_CP_CMD_NOT_IMP);
-    } else if(strcmp(pkt_received->cmd, CMD_SET_DEBUGGING) == 0) {
-        proc_set_debugging(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_SET_EFFECT) == 0) {
-        proc_set_active_effect(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_SET_COLOR) == 0) {
-        proc_set_color(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_SET_BRIGHTNESS) == 0) {
-        proc_set_brightness(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_SET_FIRE_COLOR_PALLET) == 0) {
-        proc_set_fire_color_pallet(pkt_received, pkt_response);
-    } else if(strcmp(pkt_received->cmd, CMD_GET_STATUS) == 0) {
-        proc_get_status(pkt_received, pkt_response);
-    }else {
-        proc_print_error(pkt_received, pkt_response, ERR_PROTO_CP_CMD_UNKNOWN);
+void proc_cmd(proto_pkt_t* pkt_received) {
+
+    const proto_cmd_t* cmd = proto_find_cmd(COMMANDS, COMMAND_COUNT, pkt_received);
+
+#if FEATURE_RECORDER
+    if(packetRecorder.recording()
+            && (cmd == NULL || (cmd->handler != proc_set_recording && cmd->handler != proc_get_recording))) {
+        uint16_t end = pkt_received->params.offset > 0 ?
+                    pkt_received->params.offset + pkt_received->params.len :
+                    pkt_received->cmd.offset + pkt_received->cmd.len;
+        packetRecorder.record(pktReceivedUs,
+                              pkt_received->buffer + pkt_received->cmd.offset,
+                              end - pkt_received->cmd.offset);
     }
+#endif
 
-    //reset packet
-    proto_clear_pkt(pkt_received);
+    if(cmd == NULL) {
+        protoStats.error(ERR_PROTO_CP_CMD_UNKNOWN);
+        proc_print_error(pkt_received, &pkt_response, ERR_PROTO_CP_CMD_UNKNOWN);
+        return;
+    }
+
+    protoStats.command(cmd - COMMANDS);
+
+    proto_arg_t args[MAX_PROTO_ARGS];
+    int16_t argc = proto_parse_args(cmd, pkt_received, args);
+
+    if(argc < 0) {
+        protoStats.error(argc);
+        proc_print_error(pkt_received, &pkt_response, argc);
+    } else if(cmd->coalesce && argc <= MAX_COALESCED_ARGS) {
+        proc_queue_cmd(cmd, args, argc);
+    } else {
+        proc_pending_cmds();    // Apply queued setters first so this command sees them
+        proc_run_cmd(cmd, args, argc);
+    }
 }
 
 /**
@@ -419,10 +1514,15 @@ void setup()
     // Setup serial
     Serial.begin(115200);
     Serial.println("Teensy Startup");
+    proto_init_framer(&input_framer, char_in_buffer, MAX_INPUT_BUFFER_LEN);
 
-    // Setup FastLED
-    FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);               // Add our LED strip to the FastLED library
-    FastLED.setMaxPowerInVoltsAndMilliamps(5, 10000);
+    // Setup FastLED for the saved strip length
+    uint16_t lengthin = 0x0;
+    EEPROM.get(ADDRESS_LENGTH, lengthin);
+    numLeds = lengthin >= MIN_LEDS && lengthin <= MAX_LEDS ? lengthin : MAX_LEDS;
+
+    ledController = &FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, numLeds);   // Add our LED strip to the FastLED library
+    FastLED.setMaxPowerInVoltsAndMilliamps(MAX_POWER_VOLTS, MAX_POWER_MILLIAMPS);
 
     // Read EEPROM stored parameters
     EEPROM.get(ADDRESS_BRIGHTNESS, brightness);
@@ -433,162 +1533,471 @@ void setup()
     uint32_t colorin = 0x0;
     EEPROM.get(ADDRESS_COLOR_RGB, colorin);
 
+#if FEATURE_FIRE_COLOR
     uint16_t fireColorPalletin = 0x0;
     EEPROM.get(ADDRESS_FIRE_COLOR_PALLET, fireColorPalletin);
 
+    EEPROM.get(ADDRESS_CUSTOM_PALLET, customPallet.entries);
+#endif
+
+#if FEATURE_CLIPS
+    uint8_t clipin = 0x0;
+    EEPROM.get(ADDRESS_CLIP, clipin);
+    activeClip = clipin < CLIP_COUNT ? clipin : 0;
+#endif
+
+#if FEATURE_STREAM
+    uint8_t interpolationin = 0x0;
+    EEPROM.get(ADDRESS_STREAM_INTERPOLATION, interpolationin);
+    streamInterpolator.setMode(interpolationin);
+#endif
+
+#if FEATURE_TEMPO
+    uint16_t tempoin = 0x0;
+    EEPROM.get(ADDRESS_TEMPO, tempoin);
+    tempo.setBpm(tempoin);
+
+    uint8_t beatsPerBarin = 0x0;
+    EEPROM.get(ADDRESS_BEATS_PER_BAR, beatsPerBarin);
+    tempo.setBeatsPerBar(beatsPerBarin);
+
+    uint8_t tempoSyncin = 0x0;
+    EEPROM.get(ADDRESS_TEMPO_SYNC, tempoSyncin);
+    tempoSync = tempoSyncin == 1;
+    tempo.subscribe(on_tempo_event);
+#endif
+
+#if FEATURE_RINGS
+    uint8_t ringsin = 0x0;
+    uint32_t ringCodes[MAX_RINGS];
+    uint16_t ringLeds = 0;
+    bool ringsValid = false;
+    EEPROM.get(ADDRESS_RINGS, ringsin);
+    if(ringsin > 0 && ringsin <= MAX_RINGS) {
+        ringsValid = true;
+        for(uint8_t i = 0; i < ringsin; i++) {
+            EEPROM.get(ADDRESS_RINGS + 1 + i * sizeof(uint32_t), ringCodes[i]);
+            ringLeds += ringCodes[i] >> 24;
+            ringsValid = ringsValid && ring_code_valid(ringCodes[i]) && ringLeds <= MAX_LEDS;
+        }
+    }
+    if(ringsValid) set_rings(ringCodes, ringsin);
+    else set_default_rings();
+#endif
+
     // Restore
     FastLED.setBrightness(brightness);
-    active_effect = (AvailableEffects)effectin;
+    activate_effect(effect_available(effectin) ? (AvailableEffects)effectin : AvailableEffects::OFF);
     color.setColorCode(colorin);
+#if FEATURE_FADE
+    fadeBrightness.set(brightness);
+    for(uint8_t c = 0; c < 3; c++) fadeColor[c].set(color[c]);
+#endif
+#if FEATURE_FIRE_COLOR
     fireColorPallet = (AvailableFireColorPallets)fireColorPalletin;
+#endif
 
 }
 
+#if FEATURE_COMET
+
 /**
- * @brief loop - Arduino application loop
+ * @brief draw_comet - Draws the comet a step on, or while tempo synced where the beat puts it, one
+ * sweep of the strip and back each bar
  */
-void loop()
-{
-    while(true) {
+void draw_comet() {
+
+#if FEATURE_TEMPO
+    if(tempo_synced(active_effect)) {
+        uint16_t phase = tempo.barPhase();
+        uint32_t sweep = phase < 0x8000 ? phase : 0xFFFF - phase;
+        uint32_t span = numLeds > Comet::Size ? numLeds - Comet::Size : 0;
+        comet->DrawCometAt((sweep * span) >> 15);
+        return;
+    }
+#endif
 
-        //read any pending input and process if a full cmd has been read into buffer
-        if(proc_input(&pkt_receive) > 0) {
-            proc_cmd(&pkt_receive, &pkt_response);
-        } else {
+    comet->DrawComet();
+}
 
-            switch(active_effect)
-            {
+#endif // FEATURE_COMET
 
-            case AvailableEffects::SOLID_COLOR:
-                EVERY_N_MILLISECONDS(1000)
-                {
-                    for(int i=0; i<NUM_LEDS; i++) leds[i] = color;
-                    FastLED.show();
-                }
-                break;
+#if FEATURE_RINGS
 
-            case AvailableEffects::RAINBOW_CYCLE:
-                EVERY_N_MILLISECONDS(100)
-                {
-                    hue += 1;
-                    for(int i=0; i<NUM_LEDS; i++) {
-                        leds[i].setHue(hue);
-                    }
-                    FastLED.show();
-                }
-                break;
+/**
+ * @brief effect_turn - Get how far round a turn of a repeating effect is
+ * @param periodMs - Time a turn takes when not tempo synced, a turn takes a bar when synced
+ * @return Angle, 0x10000 for a full turn
+ */
+uint16_t effect_turn(uint16_t periodMs) {
 
-            case AvailableEffects::COMET:
-                EVERY_N_MILLISECONDS(16)
-                {
-                    comet.setHue(HUE_YELLOW);
-                    comet.DrawComet();
-                    FastLED.show();
-                }
-                break;
+#if FEATURE_TEMPO
+    if(tempo_synced(active_effect)) return tempo.barPhase();
+#endif
 
-            case AvailableEffects::COMET_RAINBOW:
-                EVERY_N_MILLISECONDS(16)
-                {
-                    comet.setHue(comet.hue()+4);
-                    comet.DrawComet();
-                    FastLED.show();
-                }
-                break;
+    return ((EffectClockMs() % periodMs) << 16) / periodMs;
+}
 
-            case AvailableEffects::FIRE:
-                EVERY_N_MILLISECONDS(33)
-                {
-                    FastLED.clear();
-                    fire.DrawFire();
-                    FastLED.show();
-                }
-                break;
+/**
+ * @brief draw_spinner - Draws a quarter turn arc on each ring, neighbouring rings turning opposite
+ * ways, one turn every 2 seconds
+ */
+void draw_spinner() {
 
-            case AvailableEffects::FIRE_COLOR:
-                EVERY_N_MILLISECONDS(10)
-                {
-                    FastLED.clear();
-                    fireColor.SetPallet(fireColorPallet);
-                    fireColor.DrawFire();
-                    FastLED.show();
-                }
-                break;
+    uint16_t turn = effect_turn(2000);
+
+    for(uint8_t r = 0; r < rings.count(); r++)
+        rings.drawArc(leds, numLeds, r, (r & 1) ? -turn : turn, 0x4000, color);
+}
 
-            case AvailableEffects::SOLID_PULSE:
-                EVERY_N_MILLISECONDS(33)
-                {
-                    for(int i=0; i<NUM_LEDS; i++) {
-                        leds[i] = color;
-                    }
-                    FastLED.show();
+/**
+ * @brief draw_radar - Draws a beam sweeping round every ring with a third of a turn of trail, one
+ * sweep every 3 seconds
+ */
+void draw_radar() {
 
-                    brightness += brightnessDelta;
+    uint16_t beam = effect_turn(3000);
 
-                    const uint8_t min_pulse_brightness = 50;
-                    const uint8_t max_pulse_brightness = 175;
+    for(uint8_t r = 0; r < rings.count(); r++)
+        rings.drawRadar(leds, numLeds, r, beam, 0x5555, color);
+}
 
-                    if(brightness <= min_pulse_brightness) {
+/**
+ * @brief draw_clock - Draws the time of day as clock hands out from the centre. The hour hand
+ * covers the inner two thirds of the rings, the minute hand all of them and the second hand only
+ * the outermost. Rings that share a radius show every hand.
+ */
+void draw_clock() {
 
-                        brightness = min_pulse_brightness;
-                        brightnessDelta = 1;
+    uint32_t elapsedMs = millis() - clockSetMs;
+    uint32_t seconds = (clockSeconds + elapsedMs / 1000) % SECONDS_PER_DAY;
+    uint32_t secondMs = (seconds % 60) * 1000 + elapsedMs % 1000;
 
-                    } else if(brightness >= max_pulse_brightness) {
+    uint8_t inner, outer;
+    rings.radiusRange(inner, outer);
+    uint8_t hourOuter = inner + (outer - inner) * 2 / 3;
 
-                        brightness = max_pulse_brightness;
-                        brightnessDelta = -1;
-                    }
+    rings.drawRadial(leds, numLeds, ((seconds % 43200) << 16) / 43200, inner, hourOuter, color);
+    rings.drawRadial(leds, numLeds, ((seconds % 3600) << 16) / 3600, inner, outer, CRGB::White);
+    rings.drawRadial(leds, numLeds, (secondMs << 16) / 60000, outer, outer, CRGB(color).nscale8(64));
+}
 
-                    FastLED.setBrightness(brightness);
+#endif // FEATURE_RINGS
 
-                }
+/**
+ * @brief render_effect - Draws one frame of the active effect into the frame buffer. The caller
+ * is responsible for showing it.
+ */
+void render_effect() {
+
+    switch(active_effect)
+    {
+
+    case AvailableEffects::SOLID_COLOR:
+        kernel_fill_rgb((uint8_t*)leds, numLeds, color.r, color.g, color.b);
+        break;
+
+    case AvailableEffects::RAINBOW_CYCLE:
+#if FEATURE_TEMPO
+        if(tempo_synced(active_effect)) hue = tempo.barPhase() >> 8;
+        else hue += 1;
+#else
+        hue += 1;
+#endif
+        kernel_fill_hue((uint8_t*)leds, numLeds, hue);
+        break;
+
+#if FEATURE_COMET
+    case AvailableEffects::COMET:
+        comet->setHue(HUE_YELLOW);
+        draw_comet();
+        break;
+
+    case AvailableEffects::COMET_RAINBOW:
+        comet->setHue(comet->hue()+4);
+        draw_comet();
+        break;
+#endif
+
+#if FEATURE_FIRE
+    case AvailableEffects::FIRE:
+        FastLED.clear();
+        fire->DrawFire();
+        break;
+#endif
+
+#if FEATURE_FIRE_COLOR
+    case AvailableEffects::FIRE_COLOR:
+        FastLED.clear();
+        if(fireColorPallet == AvailableFireColorPallets::Custom)
+            fireColor->SetPallet(customPallet);
+        else
+            fireColor->SetPallet(fireColorPallet);
+        fireColor->DrawFire();
+        break;
+#endif
+
+    case AvailableEffects::SOLID_PULSE:
+        {
+            kernel_fill_rgb((uint8_t*)leds, numLeds, color.r, color.g, color.b);
+
+            const uint8_t min_pulse_brightness = 50;
+            const uint8_t max_pulse_brightness = 175;
+
+#if FEATURE_TEMPO
+            if(tempo_synced(active_effect)) {
+
+                // Peak on the beat, dim half way between beats
+                uint16_t phase = tempo.beatPhase();
+                uint16_t level = phase < 0x8000 ? 0x8000 - phase : phase - 0x8000;
+                brightness = min_pulse_brightness
+                        + (((uint32_t)(max_pulse_brightness - min_pulse_brightness) * level) >> 15);
+                FastLED.setBrightness(brightness);
                 break;
+            }
+#endif
 
-            case AvailableEffects::BOUNCING_BALL:
-                EVERY_N_MILLISECONDS(16)
-                {
-                    FastLED.clear();
-                    bouncingBall.Draw();
-                    FastLED.show();
-                }
-                break;
+            brightness += brightnessDelta;
 
-            case AvailableEffects::TWINKLE:
-                EVERY_N_MILLISECONDS(16)
-                {
-                    DrawTwinkle();
-                    FastLED.show();
-                }
-                break;
+            if(brightness <= min_pulse_brightness) {
 
-            default:
-            case AvailableEffects::MAX_EFFECT:
-            case AvailableEffects::OFF:
-                FastLED.clear(true);
-                break;
+                brightness = min_pulse_brightness;
+                brightnessDelta = 1;
 
-            };
+            } else if(brightness >= max_pulse_brightness) {
 
+                brightness = max_pulse_brightness;
+                brightnessDelta = -1;
+            }
 
+            FastLED.setBrightness(brightness);
+        }
+        break;
+
+#if FEATURE_BOUNCING_BALL
+    case AvailableEffects::BOUNCING_BALL:
+        FastLED.clear();
+        bouncingBall->Draw();
+        break;
+#endif
+
+#if FEATURE_TWINKLE
+    case AvailableEffects::TWINKLE:
+        DrawTwinkle();
+        break;
+#endif
+
+#if FEATURE_CLIPS
+    case AvailableEffects::CLIP:
+        // Delta frames are decoded over the previous frame still in leds[]
+        if(!clipDecoder.nextFrame((uint8_t*)leds, numLeds)) FastLED.clear();
+        break;
+#endif
+
+#if FEATURE_STREAM
+    case AvailableEffects::STREAM:
+        if(streamInterpolator.mode() != INTERPOLATE_OFF) {
+            // A frame presented before interpolation was turned on starts the first segment
+            if(streamPresented) {
+                streamInterpolator.present((uint8_t*)leds, (uint8_t*)streamFrame, numLeds, EffectClockMs(), false, 0);
+                streamPresented = false;
+            }
+            streamInterpolator.render((uint8_t*)leds, numLeds, EffectClockMs());
+        } else if(streamPresented) {
+            memcpy(leds, streamFrame, numLeds * sizeof(CRGB));
+            streamPresented = false;
+        }
+        break;
+#endif
+
+#if FEATURE_RINGS
+    case AvailableEffects::SPINNER:
+        FastLED.clear();
+        draw_spinner();
+        break;
+
+    case AvailableEffects::RADAR:
+        FastLED.clear();
+        draw_radar();
+        break;
+
+    case AvailableEffects::CLOCK:
+        FastLED.clear();
+        draw_clock();
+        break;
+#endif
+
+    default:
+    case AvailableEffects::MAX_EFFECT:
+    case AvailableEffects::OFF:
+        FastLED.clear();
+        break;
+
+    };
+}
 
-            if(debugging) {
+/**
+ * @brief fading - Get whether the brightness or color is fading
+ * @return
+ */
+bool fading() {
+#if FEATURE_FADE
+    return fadeBrightness.active() || fadeColor[0].active() || fadeColor[1].active() || fadeColor[2].active();
+#else
+    return false;
+#endif
+}
 
-                fps = FastLED.getFPS();
+/**
+ * @brief update_fades - Advances the brightness and color fades and sets this frame's dithered
+ * levels. Levels are saved when their fade ends.
+ */
+void update_fades() {
 
-                EVERY_N_SECONDS(1)
-                {
-                    Serial.println(fps, DEC);
-                }
+#if FEATURE_FADE
+    if(!fading()) return;
 
-            }
+    uint32_t now = EffectClockMs();
+    fadeFrame++;
 
+    if(fadeBrightness.active()) {
+        if(fadeBrightness.update(now)) EEPROM.put(ADDRESS_BRIGHTNESS, fadeBrightness.level());
+        brightness = fadeBrightness.level();
+        FastLED.setBrightness(fadeBrightness.dithered(fadeFrame));
+    }
 
+    bool colorEnded = false;
+    for(uint8_t c = 0; c < 3; c++) {
+        if(fadeColor[c].active()) {
+            colorEnded |= fadeColor[c].update(now);
+            color[c] = fadeColor[c].dithered(fadeFrame);
         }
+    }
+
+    // The channels were started together so end together
+    if(colorEnded)
+        EEPROM.put(ADDRESS_COLOR_RGB, ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b);
+#endif
+}
+
+/**
+ * @brief render_frame - Renders a frame of the active effect and shows it, recording how long
+ * each took for the frame rate tuner and the latency of any state change waiting to be shown.
+ * @param draw - Render the effect. When false the current frame buffer is only shown again.
+ */
+void render_frame(bool draw) {
+
+    uint32_t start = micros();
 
+    update_fades();
+
+    if(draw) {
+#if FEATURE_TEMPO
+        tempo.update(EffectClockMs());
+#endif
+        render_effect();
+        renderUs = micros() - start;
+        beatRenderDue = false;
+    }
+
+    if(render_requested) {
+        render_requested = false;
+        redraw_requested = false;
+        cmdLatencyUs = micros() - cmdReceivedUs;
+        if(cmdLatencyUs > cmdLatencyMaxUs) cmdLatencyMaxUs = cmdLatencyUs;
     }
 
+    uint32_t showStart = micros();
+    FastLED.show();
+    showUs = micros() - showStart;
+    lastShowMs = millis();
+    frameNumber++;
+
+    // Stepped frames run at whatever pace they're asked for, so only time effect frames
+    if(draw && !EffectClockFrozen()) frameTuner.sample(renderUs, showUs);
 }
 
+/**
+ * @brief loop - Arduino application loop
+ */
+void loop()
+{
+    while(true) {
+
+        //read any pending input and process each full cmd read into the buffer. Setters are
+        //queued so only the newest of each is applied before the next frame.
+        for(uint8_t n=0; n<MAX_PACKETS_PER_PASS && proc_input(&pkt_receive) > 0; n++) {
+            proc_cmd(&pkt_receive);
+        }
+
+        // Render when the effect's frame is due, or early when a command changed visible state.
+        // Forced renders are rate limited so a flood of commands can't starve the effect, and
+        // queued setters are only applied when a forced render could follow them.
+        uint32_t now = millis();
+        bool forceAllowed = now - lastForcedRenderMs >= MIN_FORCED_RENDER_INTERVAL_MS;
+
+        if(cmd_pending_count > 0 && forceAllowed)
+            proc_pending_cmds();
+
+        uint16_t frameInterval = frameTuner.intervalMs();
+        bool forceRender = render_requested && forceAllowed;
+
+        // Beats are rendered as they start, the clock only moves while the effect clock does
+#if FEATURE_TEMPO
+        tempo.update(EffectClockMs());
+#endif
+
+        if(EffectClockFrozen()) {
+
+            // Frozen - Only render frames asked for by Frame Step, one per pass so input is still
+            // handled between them. State changes are shown without rendering a new frame.
+            if(framesToStep > 0) {
+                framesToStep--;
+                StepEffectClock(frameInterval);
+                render_frame(true);
+            } else if(forceRender) {
+                lastForcedRenderMs = now;
+                render_frame(false);
+            }
+
+        } else if(beatRenderDue || now - lastFrameMs >= frameInterval) {
+
+            lastFrameMs = now;
+            if(forceRender) lastForcedRenderMs = now;
 
+            render_frame(true);
 
+        } else if(forceRender) {
 
+            // Early for a state change, the effect keeps its own frame schedule. Only changes to
+            // what the effect draws redraw it, the rest show the current frame again.
+            lastForcedRenderMs = now;
+            render_frame(redraw_requested);
+
+        } else if(fading() && now - lastShowMs >= FADE_SHOW_INTERVAL_MS) {
+
+            // Dithering only averages out shown often, Solid Color is redrawn so its color does too
+            render_frame(active_effect == AvailableEffects::SOLID_COLOR);
+        }
+
+#if FEATURE_READBACK
+        // Stream frame readback chunks between frames, only when the chunk won't block on output
+        if(frameReadback.active() && Serial.availableForWrite() > READBACK_CHUNK_CHARS + MAX_PROTO_CMD + 16) {
+            proc_frame_readback_chunk();
+        }
+#endif
+
+        if(debugging) {
+
+            fps = FastLED.getFPS();
+
+            EVERY_N_SECONDS(1)
+            {
+                Serial.println(fps, DEC);
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,159 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Fade tests - FadeChannel levels over long fades and temporal dithering.
+ *
+ * Run with `pio test -e native`.
+ * */
+
+#include <unity.h>
+#include "fade.h"
+
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * @brief run_fade - Runs a fade with an update every frameMs, checking it moves one way and
+ * doesn't arrive early
+ * @param from
+ * @param to
+ * @param durationMs
+ * @param frameMs
+ */
+static void run_fade(uint8_t from, uint8_t to, uint32_t durationMs, uint32_t frameMs) {
+
+    FadeChannel channel;
+    channel.set(from);
+    channel.start(to, durationMs, 0);
+
+    uint8_t last = from;
+    uint32_t now = 0;
+
+    while(now + frameMs < durationMs) {
+        now += frameMs;
+        TEST_ASSERT_FALSE(channel.update(now));
+        TEST_ASSERT_TRUE(channel.active());
+
+        uint8_t level = channel.level();
+        TEST_ASSERT_TRUE(to >= from ? level >= last && level <= to : level <= last && level >= to);
+        last = level;
+    }
+
+    TEST_ASSERT_TRUE(channel.update(durationMs));
+    TEST_ASSERT_FALSE(channel.active());
+    TEST_ASSERT_EQUAL_UINT8(to, channel.level());
+    TEST_ASSERT_EQUAL_UINT8(to, channel.dithered(0x55));
+}
+
+void test_24h_fade_lands_on_target(void) {
+    run_fade(0, 255, FADE_MAX_MS, 1000);
+    run_fade(200, 3, FADE_MAX_MS, 33);
+}
+
+void test_24h_fade_one_level_moves(void) {
+    // A one level change over 24 hours still moves every second
+    FadeChannel channel;
+    channel.set(10);
+    channel.start(11, FADE_MAX_MS, 0);
+
+    uint16_t lastUp = 0;
+    for(uint32_t now = 3600000; now < FADE_MAX_MS; now += 3600000) {
+        channel.update(now);
+        TEST_ASSERT_EQUAL_UINT8(10, channel.level());
+
+        uint16_t up = 0;
+        for(uint16_t frame = 0; frame < 256; frame++) up += channel.dithered(frame) == 11;
+        TEST_ASSERT_TRUE(up > lastUp);
+        lastUp = up;
+    }
+
+    TEST_ASSERT_TRUE(channel.update(FADE_MAX_MS));
+    TEST_ASSERT_EQUAL_UINT8(11, channel.level());
+}
+
+void test_longer_fade_is_clamped(void) {
+    FadeChannel channel;
+    channel.set(0);
+    channel.start(100, FADE_MAX_MS * 2, 0);
+    TEST_ASSERT_EQUAL_UINT32(FADE_MAX_MS, channel.remainingMs());
+    TEST_ASSERT_TRUE(channel.update(FADE_MAX_MS));
+    TEST_ASSERT_EQUAL_UINT8(100, channel.level());
+}
+
+void test_dithered_share(void) {
+    // Over 256 ms the level moves 1 << 40 a millisecond, so after t ms its fraction is t / 256
+    for(uint16_t t = 0; t < 256; t += 17) {
+        FadeChannel channel;
+        channel.set(40);
+        channel.start(41, 256, 0);
+        channel.update(t);
+
+        uint16_t up = 0;
+        for(uint16_t frame = 0; frame < 256; frame++) {
+            uint8_t level = channel.dithered(frame);
+            TEST_ASSERT_TRUE(level == 40 || level == 41);
+            up += level == 41;
+        }
+
+        TEST_ASSERT_EQUAL_UINT16(t, up);
+    }
+}
+
+void test_dithered_spread(void) {
+    // The frames that round up are spread out, every 16 frames in a row get their share
+    FadeChannel channel;
+    channel.set(0);
+    channel.start(1, 256, 0);
+    channel.update(96);
+
+    for(uint16_t start = 0; start < 256; start += 16) {
+        uint8_t up = 0;
+        for(uint16_t frame = start; frame < start + 16; frame++) up += channel.dithered(frame);
+        TEST_ASSERT_EQUAL_UINT8(6, up);
+    }
+}
+
+void test_dithered_at_top(void) {
+    // A level just under 255 rounds up to 255 and never wraps
+    FadeChannel channel;
+    channel.set(254);
+    channel.start(255, 256, 0);
+    channel.update(255);
+
+    for(uint16_t frame = 0; frame < 256; frame++)
+        TEST_ASSERT_TRUE(channel.dithered(frame) >= 254);
+
+    channel.set(255);
+    for(uint16_t frame = 0; frame < 256; frame++)
+        TEST_ASSERT_EQUAL_UINT8(255, channel.dithered(frame));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_24h_fade_lands_on_target);
+    RUN_TEST(test_24h_fade_one_level_moves);
+    RUN_TEST(test_longer_fade_is_clamped);
+    RUN_TEST(test_dithered_share);
+    RUN_TEST(test_dithered_spread);
+    RUN_TEST(test_dithered_at_top);
+    return UNITY_END();
+}
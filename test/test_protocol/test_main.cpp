@@ -0,0 +1,229 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Protocol tests - Param parsing against the command param specs and input framing with
+ * proto_frame_char().
+ *
+ * Run with `pio test -e native`.
+ * */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "protocol.h"
+
+
+static void handler(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {}
+
+static const proto_cmd_t COMMANDS[] = {
+    { "TB",     handler,    "B",    1,  1,  false },
+    { "TBW",    handler,    "BW",   1,  4,  false },
+    { "TN",     handler,    "",     0,  0,  false },
+    { "TD",     handler,    "D",    1,  1,  false },
+};
+
+static char buffer[MAX_PROTO_PACKET_LEN];
+static proto_pkt_t pkt;
+static proto_arg_t args[MAX_PROTO_ARGS];
+
+/**
+ * @brief parse - Parses a packet and its params against the command table
+ * @param packet - Packet without CRC16 or CR
+ * @return Number of params or an error code
+ */
+static int16_t parse(const char* packet) {
+
+    strlcpy(buffer, packet, sizeof(buffer));
+
+    int16_t error_code = proto_parse_pkt_buffer(buffer, strlen(buffer), &pkt);
+    if(error_code < 0) return error_code;
+
+    const proto_cmd_t* cmd = proto_find_cmd(COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]), &pkt);
+    if(cmd == NULL) return ERR_PROTO_CP_CMD_UNKNOWN;
+
+    return proto_parse_args(cmd, &pkt, args);
+}
+
+void setUp(void) {
+    memset(args, 0, sizeof(args));
+}
+
+void tearDown(void) {}
+
+void test_hex_param(void) {
+    TEST_ASSERT_EQUAL_INT16(1, parse("[TB:7F]"));
+    TEST_ASSERT_EQUAL_HEX8(0x7F, args[0].u8);
+
+    TEST_ASSERT_EQUAL_INT16(1, parse("[TB:0xfe]"));
+    TEST_ASSERT_EQUAL_HEX8(0xFE, args[0].u8);
+}
+
+void test_malformed_hex(void) {
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_INVALID, parse("[TB:G1]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_INVALID, parse("[TB:1 ]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_INVALID, parse("[TB:0x]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_INVALID, parse("[TB:]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_INVALID, parse("[TD:12A]"));
+}
+
+void test_hex_above_max(void) {
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, parse("[TB:100]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, parse("[TBW:00:10000]"));
+
+    // Leading zeros don't count against the width, only the value
+    TEST_ASSERT_EQUAL_INT16(1, parse("[TB:000000FF]"));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, args[0].u8);
+
+    uint32_t value = 0;
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, proto_parse_hex("100000000", 9, 0xFFFFFFFF, &value));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_SUCCESS, proto_parse_hex("FFFFFFFF", 8, 0xFFFFFFFF, &value));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, value);
+}
+
+void test_dec_above_max(void) {
+    TEST_ASSERT_EQUAL_INT16(1, parse("[TD:4294967295]"));
+    TEST_ASSERT_EQUAL_UINT32(4294967295UL, args[0].u32);
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, parse("[TD:4294967296]"));
+}
+
+void test_spec_repeats_last_type(void) {
+    // "BW" reads the first param as 8 bits and every further one as 16 bits
+    TEST_ASSERT_EQUAL_INT16(4, parse("[TBW:01:0203:0405:FFFF]"));
+    TEST_ASSERT_EQUAL_HEX8(0x01, args[0].u8);
+    TEST_ASSERT_EQUAL_HEX16(0x0203, args[1].u16);
+    TEST_ASSERT_EQUAL_HEX16(0x0405, args[2].u16);
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, args[3].u16);
+
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, parse("[TBW:01:0203:10000]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_PARAM_OUT_RANGE, parse("[TBW:100:0203]"));
+}
+
+void test_param_count(void) {
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_MISSING_PARAMS, parse("[TB]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_TOO_MANY_PARAMS, parse("[TB:01:02]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_TOO_MANY_PARAMS, parse("[TBW:01:02:03:04:05]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_TOO_MANY_PARAMS, parse("[TN:01]"));
+    TEST_ASSERT_EQUAL_INT16(0, parse("[TN]"));
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_CMD_UNKNOWN, parse("[TX]"));
+}
+
+
+static char frameBuffer[32];
+static proto_framer_t framer;
+static char line[MAX_PROTO_PACKET_LEN];
+
+/**
+ * @brief feed - Feeds characters to the framer, stopping at the first line or error
+ * @param chars
+ * @param fed - Set to the number of characters fed
+ * @return Result of the last character fed
+ */
+static int16_t feed(const char* chars, size_t* fed = NULL) {
+
+    int16_t result = 0;
+    size_t i = 0;
+
+    while(chars[i] != 0 && result == 0) result = proto_frame_char(&framer, chars[i++]);
+
+    if(result == PROTO_FRAME_LINE) {
+        memcpy(line, framer.buffer, framer.line_len);
+        line[framer.line_len] = 0;
+    }
+
+    if(fed != NULL) *fed = i;
+    return result;
+}
+
+void test_frame_line(void) {
+    proto_init_framer(&framer, frameBuffer, sizeof(frameBuffer));
+
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed("[CSB:FF]\r\n"));
+    TEST_ASSERT_EQUAL_STRING("[CSB:FF]", line);
+    TEST_ASSERT_EQUAL_INT16(0, feed("\n"));
+    TEST_ASSERT_EQUAL_UINT32(0, framer.wasted);
+}
+
+void test_frame_lost_cr(void) {
+    proto_init_framer(&framer, frameBuffer, sizeof(frameBuffer));
+
+    // The next packet's STX ends the packet whose CR was lost, and the next packet is kept
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_MISSING_EFC, feed("[CSB:FF][CSC:00FF00]\r"));
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed("CSC:00FF00]\r"));
+    TEST_ASSERT_EQUAL_STRING("[CSC:00FF00]", line);
+}
+
+void test_frame_stx_mid_packet(void) {
+    proto_init_framer(&framer, frameBuffer, sizeof(frameBuffer));
+
+    size_t fed = 0;
+    const char* chars = "[CS[CGS]\r";
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_MISSING_EFC, feed(chars, &fed));
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed(chars + fed));
+    TEST_ASSERT_EQUAL_STRING("[CGS]", line);
+    TEST_ASSERT_EQUAL_UINT32(3, framer.wasted);
+}
+
+void test_frame_overflow_recovery(void) {
+    proto_init_framer(&framer, frameBuffer, sizeof(frameBuffer));
+
+    char chars[2 * sizeof(frameBuffer)];
+    memset(chars, 'A', sizeof(chars) - 1);
+    chars[0] = PROTO_STX;
+    chars[sizeof(chars) - 1] = 0;
+
+    // Only reported once, the rest of the packet is skipped up to its CR without a noise error
+    size_t fed = 0;
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_CMD_OVERFLOW, feed(chars, &fed));
+    TEST_ASSERT_EQUAL(sizeof(frameBuffer) + 1, fed);
+    TEST_ASSERT_EQUAL_INT16(0, feed(chars + fed));
+    TEST_ASSERT_EQUAL_INT16(0, feed("\r"));
+
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed("[CGS]\r"));
+    TEST_ASSERT_EQUAL_STRING("[CGS]", line);
+
+    // An overflow ended by the next STX keeps that packet too
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_CMD_OVERFLOW, feed(chars));
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed("AAAA[CGT]\r"));
+    TEST_ASSERT_EQUAL_STRING("[CGT]", line);
+}
+
+void test_frame_noise(void) {
+    proto_init_framer(&framer, frameBuffer, sizeof(frameBuffer));
+
+    TEST_ASSERT_EQUAL_INT16(ERR_PROTO_CP_MISSING_STX, feed("noise\r"));
+    TEST_ASSERT_EQUAL_INT16(PROTO_FRAME_LINE, feed("xx[CGS]\r"));
+    TEST_ASSERT_EQUAL_STRING("[CGS]", line);
+    TEST_ASSERT_EQUAL_UINT32(7, framer.wasted);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hex_param);
+    RUN_TEST(test_malformed_hex);
+    RUN_TEST(test_hex_above_max);
+    RUN_TEST(test_dec_above_max);
+    RUN_TEST(test_spec_repeats_last_type);
+    RUN_TEST(test_param_count);
+    RUN_TEST(test_frame_line);
+    RUN_TEST(test_frame_lost_cr);
+    RUN_TEST(test_frame_stx_mid_packet);
+    RUN_TEST(test_frame_overflow_recovery);
+    RUN_TEST(test_frame_noise);
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Tempo tests - TempoClock tap tempo, phase and bar tracking and beat events.
+ *
+ * Run with `pio test -e native`.
+ * */
+
+#include <unity.h>
+#include "tempo.h"
+
+
+static uint8_t lastEvents;
+static uint16_t eventCount;
+
+static void listener(uint8_t events, uint16_t beat) {
+    lastEvents = events;
+    eventCount++;
+}
+
+void setUp(void) {
+    lastEvents = 0;
+    eventCount = 0;
+}
+
+void tearDown(void) {}
+
+void test_tap_averages_intervals(void) {
+    TempoClock clock;
+
+    TEST_ASSERT_FALSE(clock.tap(1000));
+    TEST_ASSERT_TRUE(clock.tap(1500));
+    TEST_ASSERT_EQUAL_UINT16(12000, clock.bpm());
+
+    // Uneven taps average over the run, 1490 ms over 3 intervals
+    TEST_ASSERT_TRUE(clock.tap(2010));
+    TEST_ASSERT_TRUE(clock.tap(2490));
+    TEST_ASSERT_EQUAL_UINT16(6000000 / 496, clock.bpm());
+}
+
+void test_tap_keeps_last_taps(void) {
+    TempoClock clock;
+    uint32_t now = 1000;
+
+    // 8 taps at 600 ms then 8 at 400 ms, only the last 8 are averaged
+    for(int i = 0; i < 8; i++, now += 600) clock.tap(now);
+    TEST_ASSERT_EQUAL_UINT16(10000, clock.bpm());
+
+    now -= 200;
+    for(int i = 0; i < 8; i++, now += 400) clock.tap(now);
+    TEST_ASSERT_EQUAL_UINT16(15000, clock.bpm());
+}
+
+void test_tap_timeout(void) {
+    TempoClock clock;
+
+    clock.tap(1000);
+    clock.tap(1400);
+    TEST_ASSERT_EQUAL_UINT16(15000, clock.bpm());
+
+    // A pause over 2 s starts a new run, its first tap keeps the tempo and starts a bar
+    TEST_ASSERT_FALSE(clock.tap(3500));
+    TEST_ASSERT_EQUAL_UINT16(15000, clock.bpm());
+    TEST_ASSERT_EQUAL_UINT8(0, clock.beatInBar());
+    TEST_ASSERT_EQUAL_UINT16(0, clock.beatPhase());
+
+    TEST_ASSERT_TRUE(clock.tap(4500));
+    TEST_ASSERT_EQUAL_UINT16(6000, clock.bpm());
+
+    // Exactly 2 s is still the same run
+    TEST_ASSERT_TRUE(clock.tap(6500));
+    TEST_ASSERT_EQUAL_UINT16(6000000 / 1500, clock.bpm());
+}
+
+void test_tap_range(void) {
+    TempoClock clock;
+
+    clock.tap(1000);
+    TEST_ASSERT_TRUE(clock.tap(1100));
+    TEST_ASSERT_EQUAL_UINT16(TEMPO_MAX_BPM, clock.bpm());
+
+    TEST_ASSERT_FALSE(clock.setBpm(TEMPO_MIN_BPM - 1));
+    TEST_ASSERT_FALSE(clock.setBpm(TEMPO_MAX_BPM + 1));
+    TEST_ASSERT_EQUAL_UINT16(TEMPO_MAX_BPM, clock.bpm());
+}
+
+void test_set_phase_keeps_beat(void) {
+    TempoClock clock;
+
+    // 120 BPM, 500 ms a beat
+    clock.update(0);
+    clock.update(1250);
+    TEST_ASSERT_EQUAL_UINT16(2, clock.beat());
+    TEST_ASSERT_UINT16_WITHIN(2, 0x8000, clock.beatPhase());
+
+    clock.setPhase(0x4000, 1250);
+    TEST_ASSERT_EQUAL_UINT16(2, clock.beat());
+    TEST_ASSERT_EQUAL_UINT16(0x4000, clock.beatPhase());
+
+    clock.setPhase(0xFFFF, 1250);
+    TEST_ASSERT_EQUAL_UINT16(2, clock.beat());
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, clock.beatPhase());
+
+    clock.setPhase(0, 1250);
+    TEST_ASSERT_EQUAL_UINT16(2, clock.beat());
+    TEST_ASSERT_EQUAL_UINT16(0, clock.beatPhase());
+}
+
+void test_bar_phase(void) {
+    TempoClock clock;
+    clock.update(0);
+
+    // Half way through the second beat of a 4 beat bar is 3 / 8 of the bar
+    clock.update(750);
+    TEST_ASSERT_EQUAL_UINT8(1, clock.beatInBar());
+    TEST_ASSERT_UINT16_WITHIN(2, 0x6000, clock.barPhase());
+
+    clock.update(1999);
+    TEST_ASSERT_EQUAL_UINT8(3, clock.beatInBar());
+    TEST_ASSERT_UINT16_WITHIN(64, 0xFFFF, clock.barPhase());
+
+    // The rate is rounded down, so a beat starts up to a millisecond late
+    clock.update(2001);
+    TEST_ASSERT_EQUAL_UINT8(0, clock.beatInBar());
+    TEST_ASSERT_UINT16_WITHIN(64, 0, clock.barPhase());
+
+    // 3 beats a bar
+    TEST_ASSERT_TRUE(clock.setBeatsPerBar(3));
+    clock.update(3250);
+    TEST_ASSERT_EQUAL_UINT8(2, clock.beatInBar());
+    TEST_ASSERT_UINT16_WITHIN(2, 0xD555, clock.barPhase());
+
+    TEST_ASSERT_FALSE(clock.setBeatsPerBar(0));
+    TEST_ASSERT_FALSE(clock.setBeatsPerBar(TEMPO_MAX_BEATS_PER_BAR + 1));
+}
+
+void test_beat_events(void) {
+    TempoClock clock;
+    clock.update(0);
+    TEST_ASSERT_TRUE(clock.subscribe(listener));
+
+    for(uint32_t now = 10; now <= 2010; now += 10) {
+        uint16_t before = eventCount;
+        clock.update(now);
+
+        if(eventCount != before)
+            TEST_ASSERT_EQUAL_UINT8(clock.beatInBar() == 0 ? TEMPO_EVENT_BEAT | TEMPO_EVENT_BAR : TEMPO_EVENT_BEAT, lastEvents);
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(4, eventCount);
+    TEST_ASSERT_EQUAL_UINT8(TEMPO_EVENT_BEAT | TEMPO_EVENT_BAR, lastEvents);
+
+    clock.unsubscribe(listener);
+    clock.update(3000);
+    TEST_ASSERT_EQUAL_UINT16(4, eventCount);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_averages_intervals);
+    RUN_TEST(test_tap_keeps_last_taps);
+    RUN_TEST(test_tap_timeout);
+    RUN_TEST(test_tap_range);
+    RUN_TEST(test_set_phase_keeps_beat);
+    RUN_TEST(test_bar_phase);
+    RUN_TEST(test_beat_events);
+    return UNITY_END();
+}
@@ -0,0 +1,346 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * bench - Benchmarks the firmware's frame buffer and fire diffusion kernels against the per pixel code they
+ * replace.
+ *
+ * Each benchmark runs a baseline, written the way the effects did it a pixel at a time with
+ * FastLED's per channel math, and the kernel on the same frame, checks they give identical
+ * frames, and reports the time per frame of each, the kernel's time per pixel or heat cell and
+ * the speedup. The host runs the portable 32bit SWAR code, so the numbers show the gain from
+ * working a word at a time; the M4 build adds its DSP instructions where the kernels use them.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -I include tools/bench/bench.cpp -o bench
+ *
+ * Usage
+ *      bench [-n pixels] [-t ms] [benchmark ...]
+ *
+ *      -n  Pixels per frame (default 300)
+ *      -t  Time to run each side of each benchmark for in ms (default 200)
+ *
+ * Runs every benchmark, or only the ones named.
+ * */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "kernels.h"
+#include "blur.h"
+
+
+/* *
+ * Per pixel baseline, the same math as FastLED's CRGB methods and lib8tion
+ * */
+static inline uint8_t scale8(uint8_t i, uint8_t scale) {
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    unsigned t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+static inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+    return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+/**
+ * @brief hsv2rgb_rainbow - FastLED's rainbow HSV to RGB conversion
+ */
+static void hsv2rgb_rainbow(uint8_t hue, uint8_t sat, uint8_t val, uint8_t* rgb) {
+
+    uint8_t offset8 = (hue & 0x1F) << 3;
+    uint8_t third = scale8(offset8, 256 / 3);
+    uint8_t r, g, b;
+
+    if(!(hue & 0x80)) {
+        if(!(hue & 0x40)) {
+            if(!(hue & 0x20)) { r = 255 - third; g = third; b = 0; }
+            else { r = 171; g = 85 + third; b = 0; }
+        } else {
+            if(!(hue & 0x20)) { uint8_t twothirds = scale8(offset8, (256 * 2) / 3); r = 171 - twothirds; g = 170 + third; b = 0; }
+            else { r = 0; g = 255 - third; b = third; }
+        }
+    } else {
+        if(!(hue & 0x40)) {
+            if(!(hue & 0x20)) { uint8_t twothirds = scale8(offset8, (256 * 2) / 3); r = 0; g = 171 - twothirds; b = 85 + twothirds; }
+            else { r = third; g = 0; b = 255 - third; }
+        } else {
+            if(!(hue & 0x20)) { r = 85 + third; g = 0; b = 171 - third; }
+            else { r = 170 + third; g = 0; b = 85 - third; }
+        }
+    }
+
+    if(sat != 255) {
+        if(sat == 0) {
+            r = 255; b = 255; g = 255;
+        } else {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+            uint8_t satscale = 255 - desat;
+            if(r) r = scale8(r, satscale) + 1;
+            if(g) g = scale8(g, satscale) + 1;
+            if(b) b = scale8(b, satscale) + 1;
+            r += desat; g += desat; b += desat;
+        }
+    }
+
+    if(val != 255) {
+        val = scale8_video(val, val);
+        if(val == 0) {
+            r = 0; g = 0; b = 0;
+        } else {
+            if(r) r = scale8(r, val) + 1;
+            if(g) g = scale8(g, val) + 1;
+            if(b) b = scale8(b, val) + 1;
+        }
+    }
+
+    rgb[0] = r;
+    rgb[1] = g;
+    rgb[2] = b;
+}
+
+typedef struct pixel_struct
+{
+    uint8_t r, g, b;
+
+    pixel_struct& setHue(uint8_t hue) {
+        hsv2rgb_rainbow(hue, 255, 255, &r);
+        return *this;
+    }
+
+    pixel_struct& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+
+    pixel_struct& fadeToBlackBy(uint8_t fade) {
+        return nscale8(255 - fade);
+    }
+
+    pixel_struct& operator+=(const pixel_struct& rhs) {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+} pixel_t;
+
+
+/* *
+ * Benchmark - Runs baseline or kernel on frame, with src as a second frame for kernels that take one
+ * */
+typedef struct benchmark_struct
+{
+    const char* name;
+    const char* baselineName;
+    void (*baseline)(pixel_t* frame, const pixel_t* src, size_t count);
+    void (*kernel)(pixel_t* frame, const pixel_t* src, size_t count);
+} benchmark_t;
+
+// Keeps each pass's result live so the loops aren't optimized away
+static volatile uint8_t sink;
+
+static const benchmark_t BENCHMARKS[] =
+{
+    {
+        "scale", "nscale8(250) per pixel",
+        [](pixel_t* f, const pixel_t*, size_t n) { for(size_t i = 0; i < n; i++) f[i].nscale8(250); },
+        [](pixel_t* f, const pixel_t*, size_t n) { kernel_scale8((uint8_t*)f, n * 3, 250); },
+    },
+    {
+        "fade", "fadeToBlackBy(20) per pixel",
+        [](pixel_t* f, const pixel_t*, size_t n) { for(size_t i = 0; i < n; i++) f[i].fadeToBlackBy(20); },
+        [](pixel_t* f, const pixel_t*, size_t n) { kernel_fade8((uint8_t*)f, n * 3, 20); },
+    },
+    {
+        "qadd", "+= per pixel",
+        [](pixel_t* f, const pixel_t* s, size_t n) { for(size_t i = 0; i < n; i++) f[i] += s[i]; },
+        [](pixel_t* f, const pixel_t* s, size_t n) { kernel_qadd8((uint8_t*)f, (const uint8_t*)s, n * 3); },
+    },
+    {
+        "fill", "= color per pixel",
+        [](pixel_t* f, const pixel_t* s, size_t n) { for(size_t i = 0; i < n; i++) f[i] = s[0]; },
+        [](pixel_t* f, const pixel_t* s, size_t n) { kernel_fill_rgb((uint8_t*)f, n, s[0].r, s[0].g, s[0].b); },
+    },
+    {
+        "hue", "setHue() per pixel",
+        [](pixel_t* f, const pixel_t* s, size_t n) { for(size_t i = 0; i < n; i++) f[i].setHue(s[0].r); },
+        [](pixel_t* f, const pixel_t* s, size_t n) { kernel_fill_hue((uint8_t*)f, n, s[0].r); },
+    },
+    {
+        "gradient", "setHue(hue++) per pixel",
+        [](pixel_t* f, const pixel_t* s, size_t n) { uint8_t h = s[0].r; for(size_t i = 0; i < n; i++) f[i].setHue(h++); },
+        [](pixel_t* f, const pixel_t* s, size_t n) { kernel_fill_hue_gradient((uint8_t*)f, n, s[0].r, 1); },
+    },
+    {
+        "marquee", "setHue(hue += 8) per pixel",
+        [](pixel_t* f, const pixel_t* s, size_t n) { uint8_t h = s[0].r; for(size_t i = 0; i < n; i++, h += 8) f[i].setHue(h); },
+        [](pixel_t* f, const pixel_t* s, size_t n) { kernel_fill_hue_gradient((uint8_t*)f, n, s[0].r, 8); },
+    },
+    {
+        "fire", "FireEffect diffusion, % and / 8",
+        [](pixel_t* f, const pixel_t*, size_t n) {
+            uint8_t* heat = (uint8_t*)f;
+            for(size_t i = 0; i < n; i++)
+                heat[i] = (heat[i] * 2 + heat[(i + 1) % n] * 3 + heat[(i + 2) % n] * 2 + heat[(i + 3) % n] * 1) / 8;
+        },
+        [](pixel_t* f, const pixel_t*, size_t n) {
+            const uint8_t weights[] = { 2, 3, 2, 1 };
+            kernel_advect8_down<4>((uint8_t*)f, n, 1, weights, 8, true);
+        },
+    },
+};
+
+
+void usage() {
+    fprintf(stderr, "usage: bench [-n pixels] [-t ms] [benchmark ...]\n");
+    exit(1);
+}
+
+static uint64_t clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief fill_random - Fills a frame with random pixels
+ * @param frame
+ * @param count
+ */
+static void fill_random(std::vector<pixel_t>* frame, size_t count) {
+    frame->resize(count);
+    for(pixel_t& p : *frame) {
+        p.r = rand();
+        p.g = rand();
+        p.b = rand();
+    }
+}
+
+/**
+ * @brief time_pass - Times a function on a fresh copy of a frame until the time is up
+ * @param fn
+ * @param start - Frame each pass starts from
+ * @param src
+ * @param ms
+ * @return Nanoseconds per frame
+ */
+static double time_pass(void (*fn)(pixel_t*, const pixel_t*, size_t), const std::vector<pixel_t>& start,
+                        const std::vector<pixel_t>& src, int ms) {
+
+    std::vector<pixel_t> frame = start;
+    uint64_t elapsed = 0, passes = 0;
+    uint64_t begin = clock_ns();
+
+    // The fades reach black after a few hundred passes, restart from the frame well before that
+    do {
+        memcpy(frame.data(), start.data(), start.size() * sizeof(pixel_t));
+        uint64_t t = clock_ns();
+        for(int i = 0; i < 64; i++) fn(frame.data(), src.data(), frame.size());
+        elapsed += clock_ns() - t;
+        passes += 64;
+        sink = frame[frame.size() / 2].g;
+    } while(clock_ns() - begin < (uint64_t)ms * 1000000ULL);
+
+    return (double)elapsed / passes;
+}
+
+int main(int argc, char** argv) {
+
+    int pixels = 300, ms = 200;
+
+    int opt;
+    while((opt = getopt(argc, argv, "n:t:")) != -1) {
+        switch(opt) {
+        case 'n': pixels = atoi(optarg); break;
+        case 't': ms = atoi(optarg); break;
+        default: usage();
+        }
+    }
+
+    if(pixels <= 0 || ms <= 0) usage();
+
+    srand(1);
+    std::vector<pixel_t> start, src;
+    fill_random(&start, pixels);
+    fill_random(&src, pixels);
+
+    std::vector<size_t> counts;
+    for(size_t count = 0; count <= 17 && count < start.size(); count++) counts.push_back(count);
+    counts.push_back(start.size());
+
+    // Every hue, not just the ones the benchmarks use
+    for(int hue = 0; hue < 256; hue++) {
+        pixel_t expected, actual;
+        expected.setHue(hue);
+        kernel_hue_rgb(hue, &actual.r);
+        if(memcmp(&expected, &actual, 3) != 0) {
+            fprintf(stderr, "bench: kernel_hue_rgb doesn't match the baseline for hue %02X\n", hue);
+            return 1;
+        }
+    }
+
+    printf("%-9s %-34s %12s %12s %10s %8s\n", "", "baseline", "baseline", "kernel", "per cell", "speedup");
+
+    for(const benchmark_t& b : BENCHMARKS) {
+
+        bool selected = optind >= argc;
+        for(int i = optind; i < argc; i++) selected |= strcmp(argv[i], b.name) == 0;
+        if(!selected) continue;
+
+        // Same result for every short length and the whole frame at every alignment, pixels start on
+        // any byte in a frame
+        for(size_t count : counts) {
+            for(size_t offset = 0; offset < 4; offset++) {
+
+                std::vector<uint8_t> expected(offset + count * 3 + 4), actual;
+                memcpy(&expected[offset], start.data(), count * 3);
+                actual = expected;
+
+                b.baseline((pixel_t*)&expected[offset], src.data(), count);
+                b.kernel((pixel_t*)&actual[offset], src.data(), count);
+
+                if(expected != actual) {
+                    fprintf(stderr, "bench: %s kernel doesn't match the baseline for %zu pixels at offset %zu\n",
+                            b.name, count, offset);
+                    return 1;
+                }
+            }
+        }
+
+        double baselineNs = time_pass(b.baseline, start, src, ms);
+        double kernelNs = time_pass(b.kernel, start, src, ms);
+
+        printf("%-9s %-34s %10.0fns %10.0fns %8.2fns %7.1fx\n", b.name, b.baselineName, baselineNs, kernelNs,
+               kernelNs / pixels, baselineNs / kernelNs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * clipenc - Encodes pre-rendered animations into clips (include/clip.h) for the CLIP effect.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -I tools/host -I include tools/clipenc/clipenc.cpp -o clipenc
+ *
+ * Usage
+ *      clipenc (-i frames | -g sample) [-n pixels] [-F frames] [-f frame ms] [-p] [-k interval]
+ *              [-o clip] [-c name]
+ *
+ *      -i  Raw frame file, frames of pixels * 3 bytes RGB back to back
+ *      -g  Generate a sample clip instead: comet, rainbow, pulse, sparkle or noise
+ *      -n  Pixels per frame (default 300)
+ *      -F  Frames to generate with -g (default 240)
+ *      -f  Frame interval in ms (default 16)
+ *      -p  Use a palette when the clip has 256 colors or less
+ *      -k  Force a key frame every interval frames
+ *      -o  Write the clip to a binary file
+ *      -c  Write the clip as a C array called name to stdout, for include/clips.h
+ *
+ * Prints the compression ratio against raw RGB frames and the time taken to decode a frame with
+ * the firmware's decoder on this host.
+ * */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "clip.h"
+#include "clipencode.h"
+
+
+void usage() {
+    fprintf(stderr, "usage: clipenc (-i frames | -g sample) [-n pixels] [-F frames] [-f frame ms] [-p] [-k interval] [-o clip] [-c name]\n");
+    exit(1);
+}
+
+static uint64_t clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief hsv - Full saturation and value hue to RGB
+ * @param hue - 0 to 1
+ * @param rgb
+ */
+static void hsv(float hue, uint8_t* rgb) {
+    float h = (hue - floorf(hue)) * 6.0f;
+    float x = 1.0f - fabsf(fmodf(h, 2.0f) - 1.0f);
+    float r = 0, g = 0, b = 0;
+
+    switch((int)h) {
+    case 0: r = 1; g = x; break;
+    case 1: r = x; g = 1; break;
+    case 2: g = 1; b = x; break;
+    case 3: g = x; b = 1; break;
+    case 4: r = x; b = 1; break;
+    default: r = 1; b = x; break;
+    }
+
+    rgb[0] = r * 255;
+    rgb[1] = g * 255;
+    rgb[2] = b * 255;
+}
+
+/**
+ * @brief generate - Renders a sample clip
+ * @param name
+ * @param pixels
+ * @param count
+ * @param frames - Set to the frames
+ * @return false for an unknown sample
+ */
+static bool generate(const std::string& name, uint16_t pixels, uint16_t count, std::vector<uint8_t>* frames) {
+
+    frames->assign((size_t)pixels * 3 * count, 0);
+    srand(1);
+
+    for(uint16_t f = 0; f < count; f++) {
+
+        uint8_t* frame = &(*frames)[(size_t)f * pixels * 3];
+
+        if(name == "comet") {
+
+            // Yellow comet with a fading tail bouncing along the strip
+            int span = 2 * (pixels - 1);
+            int head = (f * 3) % span;
+            if(head >= pixels) head = span - head;
+
+            for(int t = 0; t < 12; t++) {
+                int p = head - t;
+                if(p < 0 || p >= pixels) continue;
+                frame[p * 3] = 255 >> (t / 2);
+                frame[p * 3 + 1] = 200 >> (t / 2);
+            }
+
+        } else if(name == "rainbow") {
+
+            for(uint16_t p = 0; p < pixels; p++) hsv((float)p / pixels + (float)f / count, &frame[p * 3]);
+
+        } else if(name == "pulse") {
+
+            // Solid color with a stepped brightness, only a handful of colors
+            uint8_t level = 64 + (uint8_t)(127 * (0.5f + 0.5f * sinf(f * 2 * M_PI / 60))) / 16 * 16;
+            for(uint16_t p = 0; p < pixels; p++) {
+                frame[p * 3] = level;
+                frame[p * 3 + 1] = level / 4;
+            }
+
+        } else if(name == "sparkle") {
+
+            // Pixels lit white for a few frames on a dark background
+            if(f > 0) memcpy(frame, frame - pixels * 3, pixels * 3);
+            for(uint16_t p = 0; p < pixels; p++) if(frame[p * 3] > 0) memset(&frame[p * 3], frame[p * 3] - 85, 3);
+            for(int i = 0; i < pixels / 50 + 1; i++) memset(&frame[(rand() % pixels) * 3], 255, 3);
+
+        } else if(name == "noise") {
+
+            // Worst case, nothing repeats
+            for(size_t i = 0; i < (size_t)pixels * 3; i++) frame[i] = rand();
+
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    const char* in = nullptr;
+    const char* out = nullptr;
+    const char* arrayName = nullptr;
+    std::string sample;
+    int pixels = 300, count = 240, frameMs = 16, keyInterval = 0;
+    bool usePalette = false;
+
+    int opt;
+    while((opt = getopt(argc, argv, "i:g:n:F:f:pk:o:c:")) != -1) {
+        switch(opt) {
+        case 'i': in = optarg; break;
+        case 'g': sample = optarg; break;
+        case 'n': pixels = atoi(optarg); break;
+        case 'F': count = atoi(optarg); break;
+        case 'f': frameMs = atoi(optarg); break;
+        case 'p': usePalette = true; break;
+        case 'k': keyInterval = atoi(optarg); break;
+        case 'o': out = optarg; break;
+        case 'c': arrayName = optarg; break;
+        default: usage();
+        }
+    }
+
+    if((in == nullptr) == sample.empty() || pixels <= 0 || pixels > 0xFFFF || count <= 0 || frameMs <= 0) usage();
+
+    std::vector<uint8_t> frames;
+
+    if(in) {
+
+        FILE* f = fopen(in, "rb");
+        if(f == nullptr) {
+            fprintf(stderr, "clipenc: can't open %s\n", in);
+            return 1;
+        }
+
+        uint8_t buff[65536];
+        size_t n;
+        while((n = fread(buff, 1, sizeof(buff), f)) > 0) frames.insert(frames.end(), buff, buff + n);
+        fclose(f);
+
+        count = frames.size() / (pixels * 3);
+
+        if(count == 0 || count > 0xFFFF) {
+            fprintf(stderr, "clipenc: %s has %d frames of %d pixels\n", in, count, pixels);
+            return 1;
+        }
+
+    } else if(!generate(sample, pixels, count, &frames)) {
+        fprintf(stderr, "clipenc: unknown sample %s\n", sample.c_str());
+        return 1;
+    }
+
+    uint16_t keyFrames;
+    std::vector<uint8_t> clip = clip_encode(frames.data(), count, pixels, frameMs, usePalette, keyInterval, &keyFrames);
+
+    // Decode it back to check it and time the decoder
+    ClipDecoder decoder;
+    std::vector<uint8_t> leds(pixels * 3);
+
+    if(!decoder.begin(clip.data(), clip.size())) {
+        fprintf(stderr, "clipenc: encoded clip is invalid\n");
+        return 1;
+    }
+
+    for(int f = 0; f < count; f++) {
+        if(!decoder.nextFrame(leds.data(), pixels) || memcmp(leds.data(), &frames[(size_t)f * pixels * 3], pixels * 3) != 0) {
+            fprintf(stderr, "clipenc: frame %d does not decode to the original\n", f);
+            return 1;
+        }
+    }
+
+    int loops = 0;
+    uint64_t start = clock_ns(), elapsed;
+    do {
+        decoder.restart();
+        for(int f = 0; f < count; f++) decoder.nextFrame(leds.data(), pixels);
+        loops++;
+        elapsed = clock_ns() - start;
+    } while(elapsed < 200000000ULL);
+
+    size_t raw = frames.size();
+    fprintf(stderr, "%s: %d frames of %d pixels, %u key frames, %s\n",
+            in ? in : sample.c_str(), count, pixels, keyFrames, clip[5] & CLIP_FLAG_PALETTE ? "palette" : "RGB");
+    fprintf(stderr, "%zu bytes raw, %zu bytes clip, %.1fx, %.1f bytes/frame, decode %.2fus/frame\n",
+            raw, clip.size(), (double)raw / clip.size(), (double)clip.size() / count,
+            elapsed / 1000.0 / loops / count);
+
+    if(out) {
+        FILE* f = fopen(out, "wb");
+        if(f == nullptr || fwrite(clip.data(), 1, clip.size(), f) != clip.size()) {
+            fprintf(stderr, "clipenc: can't write %s\n", out);
+            return 1;
+        }
+        fclose(f);
+    }
+
+    if(arrayName) {
+        printf("// %s, %d frames of %d pixels at %dms\n", in ? in : sample.c_str(), count, pixels, frameMs);
+        printf("const uint8_t %s[%zu] = {", arrayName, clip.size());
+        for(size_t i = 0; i < clip.size(); i++) printf("%s0x%02X,", i % 16 ? " " : "\n    ", clip[i]);
+        printf("\n};\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,507 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * frameplayer - Streams a pre-rendered frame file to one or more controllers running the Stream
+ * effect, at a fixed frame rate.
+ *
+ * The frame file is raw RGB frames of pixels * 3 bytes back to back and is memory mapped, so its
+ * size is only limited by the address space. A lookahead thread encodes frames into Write Frame
+ * (CWF) packets ahead of time. The sender sends each frame at its due time on an absolute schedule
+ * from the start of playback, so timing errors don't accumulate into drift. Frames that would be
+ * sent more than a frame late are dropped to catch up.
+ *
+ * With -d frames are sent as delta ops (see include/clip.h) against the previous frame sent. A
+ * frame after a dropped one, and every -k frames, is sent as a full frame.
+ *
+ * With -I the controllers interpolate between frames and each frame is presented with its
+ * timestamp, so the file can be played at a fraction of the controllers' frame rate.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -pthread -I tools/host -I include tools/frameplayer/frameplayer.cpp -o frameplayer
+ *
+ * Usage
+ *      frameplayer -i frames -n pixels -p port [-p port ...] [-r fps] [-d] [-k interval]
+ *                  [-a lookahead] [-I mode] [-t seconds] [-L] [-c]
+ *
+ *      -i  Frame file
+ *      -n  Pixels per frame
+ *      -p  Controller port, a Teensy or a loadsim controller PTY. Repeat for more controllers,
+ *          each one is sent every frame
+ *      -r  Frames per second (default 30)
+ *      -d  Send delta frames
+ *      -k  Send a full frame every interval frames with -d (default 60)
+ *      -a  Frames encoded ahead (default 8)
+ *      -I  Stream interpolation mode, 1 linear or 2 perceptual (default 0, off)
+ *      -t  Stop after seconds
+ *      -L  Loop the frame file
+ *      -c  Check the last frame shown on each controller against the file (CGFC)
+ * */
+
+#include <Arduino.h>
+#include "protocol.h"
+#include "clip.h"
+#include "clipencode.h"
+#include "hostport.h"
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#define EFFECT_STREAM               0x0B                    // AvailableEffects::STREAM
+#define WRITE_FRAME_DELTA           0x01
+#define WRITE_FRAME_PRESENT         0x02
+#define INTERPOLATE_MODES           3
+#define RAW_PIXELS_PER_PACKET       80                      // 480 HEX characters
+#define DELTA_BYTES_PER_PACKET      240                     // 480 HEX characters
+
+static std::atomic<bool> running(true);
+
+
+/* *
+ * One frame encoded into packets
+ * */
+typedef struct encoded_frame_struct
+{
+    uint32_t index;                         // Frame index in the file
+    uint64_t sequence;                      // Frame number since playback started
+    bool full;                              // Full frame rather than delta
+    int64_t timestampMs;                    // Sent with the present, -1 for none
+    std::vector<std::string> packets;       // Framed CWF packets
+} encoded_frame_t;
+
+
+/* *
+ * Controller connection
+ * */
+typedef struct controller_struct
+{
+    const char* port;
+    int fd;
+    std::thread reader;
+    std::atomic<uint64_t> acks;             // Responses received
+    std::atomic<uint64_t> errors;           // Error responses
+} controller_t;
+
+
+static void stop(int) {
+    running = false;
+}
+
+void usage() {
+    fprintf(stderr, "usage: frameplayer -i frames -n pixels -p port [-p port ...] [-r fps] [-d] [-k interval] [-a lookahead] [-I mode] [-t seconds] [-L] [-c]\n");
+    exit(1);
+}
+
+/**
+ * @brief add_packet - Frames a CWF packet. A present carries the frame's timestamp, if it has one.
+ * @param frame
+ * @param first - First pixel
+ * @param flags - WRITE_FRAME_ flags
+ * @param data - Data as bytes, sent as HEX
+ * @param len - Length of data
+ */
+static void add_packet(encoded_frame_t* frame, uint16_t first, uint8_t flags, const uint8_t* data, size_t len) {
+    static const char digits[] = "0123456789ABCDEF";
+    char body[MAX_PROTO_PACKET_LEN];
+    char packet[MAX_PROTO_PACKET_LEN + 8];
+
+    int n = snprintf(body, sizeof(body), "CWF:%04X:%02X", first, flags);
+
+    bool timestamp = (flags & WRITE_FRAME_PRESENT) && frame->timestampMs >= 0;
+
+    if(len > 0 || timestamp) {
+        body[n++] = PROTO_PSC;
+        for(size_t i = 0; i < len; i++) {
+            body[n++] = digits[data[i] >> 4];
+            body[n++] = digits[data[i] & 0x0F];
+        }
+        body[n] = 0;
+    }
+
+    if(timestamp) snprintf(body + n, sizeof(body) - n, "%c%08X", PROTO_PSC, (uint32_t)frame->timestampMs);
+
+    size_t packetLen = host_build_packet(body, packet, sizeof(packet));
+    frame->packets.emplace_back(packet, packetLen);
+}
+
+/**
+ * @brief encode_full - Encodes a frame as RGB pixels
+ * @param frame
+ * @param rgb
+ * @param pixels
+ */
+static void encode_full(encoded_frame_t* frame, const uint8_t* rgb, uint16_t pixels) {
+    frame->full = true;
+    frame->packets.clear();
+
+    for(uint16_t p = 0; p < pixels; p += RAW_PIXELS_PER_PACKET) {
+        uint16_t n = std::min<uint16_t>(RAW_PIXELS_PER_PACKET, pixels - p);
+        add_packet(frame, p, p + n >= pixels ? WRITE_FRAME_PRESENT : 0, &rgb[p * 3], n * 3);
+    }
+}
+
+/**
+ * @brief encode_delta - Encodes a frame as delta ops against the previous frame, split into
+ * packets at op boundaries. Skips at the start of a packet become its first pixel and trailing
+ * skips are not sent.
+ * @param frame
+ * @param rgb
+ * @param prev
+ * @param pixels
+ */
+static void encode_delta(encoded_frame_t* frame, const uint8_t* rgb, const uint8_t* prev, uint16_t pixels) {
+
+    std::vector<uint8_t> ops;
+    clip_encode_frame(&ops, rgb, prev, pixels, nullptr);
+
+    frame->full = false;
+    frame->packets.clear();
+
+    // Packets as first pixel, start and end of their ops
+    std::vector<std::tuple<uint16_t, size_t, size_t>> chunks;
+    size_t pos = 1;                         // Past the frame type
+    uint16_t p = 0;
+
+    while(true) {
+
+        // Leading skips become the first pixel of the packet
+        while(pos < ops.size() && (ops[pos] & CLIP_OP_MASK) == CLIP_OP_SKIP) {
+            p += (ops[pos] & CLIP_RUN_MASK) + 1;
+            pos++;
+        }
+
+        if(pos >= ops.size()) break;
+
+        size_t start = pos;
+        uint16_t first = p;
+
+        while(pos < ops.size()) {
+
+            uint8_t op = ops[pos] & CLIP_OP_MASK;
+            uint16_t run = (ops[pos] & CLIP_RUN_MASK) + 1;
+            size_t len = op == CLIP_OP_LITERAL ? 1 + run * 3 : op == CLIP_OP_REPEAT ? 4 : 1;
+
+            if(pos + len - start > DELTA_BYTES_PER_PACKET) break;
+
+            pos += len;
+            p += run;
+        }
+
+        // Trailing skips aren't sent, the next packet starts past them
+        size_t end = pos;
+        while(end > start && (ops[end - 1] & CLIP_OP_MASK) == CLIP_OP_SKIP) end--;
+
+        chunks.emplace_back(first, start, end);
+    }
+
+    // Present with the last packet, or on its own when nothing changed
+    if(chunks.empty()) {
+        add_packet(frame, 0, WRITE_FRAME_DELTA | WRITE_FRAME_PRESENT, nullptr, 0);
+        return;
+    }
+
+    for(size_t i = 0; i < chunks.size(); i++) {
+        uint8_t flags = WRITE_FRAME_DELTA | (i + 1 == chunks.size() ? WRITE_FRAME_PRESENT : 0);
+        size_t start = std::get<1>(chunks[i]);
+        add_packet(frame, std::get<0>(chunks[i]), flags, &ops[start], std::get<2>(chunks[i]) - start);
+    }
+}
+
+/**
+ * @brief read_responses - Counts the responses from a controller
+ * @param c
+ */
+static void read_responses(controller_t* c) {
+    char line[MAX_PROTO_PACKET_LEN];
+
+    while(running) {
+
+        if(host_read_line(c->fd, line, sizeof(line), 100) < 0) continue;
+        if(line[0] != PROTO_STX) continue;
+
+        const char* psc = strchr(line, PROTO_PSC);
+        int error = psc ? atoi(psc + 1) : ERR_PROTO_CP_MISSING_PARAMS;
+
+        c->acks++;
+        if(error != ERR_PROTO_SUCCESS) c->errors++;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    const char* in = nullptr;
+    std::vector<const char*> ports;
+    int pixels = 0, fps = 30, keyInterval = 60, lookahead = 8, seconds = 0, interpolation = 0;
+    bool delta = false, loop = false, check = false;
+
+    int opt;
+    while((opt = getopt(argc, argv, "i:n:p:r:dk:a:I:t:Lc")) != -1) {
+        switch(opt) {
+        case 'i': in = optarg; break;
+        case 'n': pixels = atoi(optarg); break;
+        case 'p': ports.push_back(optarg); break;
+        case 'r': fps = atoi(optarg); break;
+        case 'd': delta = true; break;
+        case 'k': keyInterval = atoi(optarg); break;
+        case 'a': lookahead = atoi(optarg); break;
+        case 'I': interpolation = atoi(optarg); break;
+        case 't': seconds = atoi(optarg); break;
+        case 'L': loop = true; break;
+        case 'c': check = true; break;
+        default: usage();
+        }
+    }
+
+    if(in == nullptr || ports.empty() || pixels <= 0 || pixels > 0xFFFF || fps <= 0 || keyInterval <= 0 || lookahead <= 0
+            || interpolation < 0 || interpolation >= INTERPOLATE_MODES)
+        usage();
+
+    // Map the frame file
+    int fileFd = open(in, O_RDONLY);
+    struct stat st;
+    if(fileFd < 0 || fstat(fileFd, &st) != 0) {
+        fprintf(stderr, "frameplayer: can't open %s\n", in);
+        return 1;
+    }
+
+    const size_t frameLen = (size_t)pixels * 3;
+    const uint32_t frameCount = st.st_size / frameLen;
+    if(frameCount == 0) {
+        fprintf(stderr, "frameplayer: %s has no whole frames of %d pixels\n", in, pixels);
+        return 1;
+    }
+
+    const uint8_t* frames = (const uint8_t*)mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fileFd, 0);
+    if(frames == MAP_FAILED) {
+        fprintf(stderr, "frameplayer: can't map %s\n", in);
+        return 1;
+    }
+    madvise((void*)frames, st.st_size, MADV_SEQUENTIAL);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    // Sends a command and waits for its response
+    auto command = [](int fd, const char* body) {
+        char packet[32], line[MAX_PROTO_PACKET_LEN];
+        size_t len = host_build_packet(body, packet, sizeof(packet));
+        return fd >= 0 && host_write_all(fd, packet, len) && host_read_line(fd, line, sizeof(line), 2000) >= 0;
+    };
+
+    // Connect and switch the controllers to the Stream effect
+    std::vector<controller_t*> controllers;
+    for(const char* port : ports) {
+
+        controller_t* c = new controller_t();
+        c->port = port;
+        c->fd = host_open_port(port);
+
+        char interpolate[16], effect[16];
+        snprintf(interpolate, sizeof(interpolate), "CSSI:%02X", interpolation);
+        snprintf(effect, sizeof(effect), "CSE:%02X", EFFECT_STREAM);
+
+        if(!command(c->fd, interpolate) || !command(c->fd, effect)) {
+            fprintf(stderr, "frameplayer: no response from %s\n", port);
+            return 1;
+        }
+
+        controllers.push_back(c);
+    }
+
+    for(controller_t* c : controllers)
+        c->reader = std::thread(read_responses, c);
+
+    // Lookahead - encodes frames into packets ahead of the sender
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<encoded_frame_t> queue;
+
+    std::thread encoder([&]() {
+        for(uint64_t seq = 0; running; seq++) {
+
+            uint32_t index = seq % frameCount;
+            if(!loop && seq >= frameCount) break;
+
+            encoded_frame_t frame;
+            frame.index = index;
+            frame.sequence = seq;
+            frame.timestampMs = interpolation ? (int64_t)(seq * 1000 / fps) : -1;
+
+            const uint8_t* rgb = &frames[index * frameLen];
+            if(!delta || seq == 0 || seq % keyInterval == 0)
+                encode_full(&frame, rgb, pixels);
+            else
+                encode_delta(&frame, rgb, &frames[((seq - 1) % frameCount) * frameLen], pixels);
+
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]() { return (int)queue.size() < lookahead || !running; });
+            queue.push_back(std::move(frame));
+            changed.notify_all();
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        queue.push_back(encoded_frame_t());         // End marker, no packets
+        changed.notify_all();
+    });
+
+    // Sender - absolute schedule from the start of playback
+    const uint64_t intervalNs = 1000000000ULL / fps;
+    struct timespec startTs;
+    clock_gettime(CLOCK_MONOTONIC, &startTs);
+    const uint64_t startNs = (uint64_t)startTs.tv_sec * 1000000000ULL + startTs.tv_nsec + 100000000ULL;
+
+    std::vector<uint32_t> lateUs;
+    uint64_t sent = 0, dropped = 0, late = 0, bytes = 0, fullFrames = 0;
+    bool needFull = false;
+    int64_t lastSent = -1;
+    uint32_t lastIndex = 0;
+
+    while(running) {
+
+        encoded_frame_t frame;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]() { return !queue.empty() || !running; });
+            if(!running) break;
+            frame = std::move(queue.front());
+            queue.pop_front();
+            changed.notify_all();
+        }
+
+        if(frame.packets.empty()) break;
+
+        uint64_t dueNs = startNs + frame.sequence * intervalNs;
+
+        if(seconds > 0 && dueNs - startNs >= (uint64_t)seconds * 1000000000ULL) break;
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t nowNs = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+        // More than a frame behind, drop frames until caught up
+        if(nowNs > dueNs + intervalNs) {
+            dropped++;
+            needFull = true;
+            continue;
+        }
+
+        if(nowNs < dueNs) {
+            struct timespec due = { (time_t)(dueNs / 1000000000ULL), (long)(dueNs % 1000000000ULL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, nullptr);
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            nowNs = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+        }
+
+        uint32_t lateness = (nowNs - dueNs) / 1000;
+        lateUs.push_back(lateness);
+        if(lateness * 1000ULL > intervalNs / 4) late++;
+
+        // A delta against a frame the controllers never got would be wrong
+        if(!frame.full && (needFull || lastSent != (int64_t)frame.sequence - 1))
+            encode_full(&frame, &frames[frame.index * frameLen], pixels);
+
+        needFull = false;
+        if(frame.full) fullFrames++;
+
+        for(controller_t* c : controllers) {
+            for(const std::string& packet : frame.packets) {
+                if(!host_write_all(c->fd, packet.data(), packet.size())) {
+                    fprintf(stderr, "frameplayer: write to %s failed\n", c->port);
+                    running = false;
+                    break;
+                }
+                bytes += packet.size();
+            }
+        }
+
+        lastSent = frame.sequence;
+        lastIndex = frame.index;
+        sent++;
+    }
+
+    struct timespec endTs;
+    clock_gettime(CLOCK_MONOTONIC, &endTs);
+    double elapsed = ((uint64_t)endTs.tv_sec * 1000000000ULL + endTs.tv_nsec - startNs) / 1e9;
+
+    // Let the responses to the last frame come in
+    usleep(200000);
+    bool wasRunning = running;
+    running = false;
+    changed.notify_all();
+    encoder.join();
+    for(controller_t* c : controllers) c->reader.join();
+
+    // Size of a frame sent as a full frame, to compare the deltas against
+    encoded_frame_t full = encoded_frame_t();
+    size_t fullLen = 0;
+    encode_full(&full, frames, pixels);
+    for(const std::string& packet : full.packets) fullLen += packet.size();
+
+    double rawBytes = (double)sent * controllers.size() * fullLen;
+    printf("%llu frames sent in %.2fs, %.2f fps (target %d), %llu late, %llu dropped, %llu full frames\n",
+           (unsigned long long)sent, elapsed, sent > 1 ? (sent - 1) / elapsed : 0.0, fps,
+           (unsigned long long)late, (unsigned long long)dropped, (unsigned long long)fullFrames);
+    printf("send lateness p50 %uus, p99 %uus, max %uus\n",
+           (unsigned)host_percentile(lateUs, 50),
+           (unsigned)host_percentile(lateUs, 99),
+           (unsigned)host_percentile(lateUs, 100));
+    printf("%.0f bytes/frame per controller, %.1f%% of full frames\n",
+           sent ? (double)bytes / sent / controllers.size() : 0.0, rawBytes > 0 ? 100.0 * bytes / rawBytes : 0.0);
+
+    for(controller_t* c : controllers) {
+        printf("%s: %llu responses, %llu errors\n", c->port,
+               (unsigned long long)c->acks, (unsigned long long)c->errors);
+    }
+
+    // Compare the frame buffer of each controller with the last frame sent
+    if(check && wasRunning && sent > 0) {
+        uint16_t expected = crc16_buffer(0, (uint8_t*)&frames[lastIndex * frameLen], 0, frameLen);
+
+        for(controller_t* c : controllers) {
+            char packet[32], line[MAX_PROTO_PACKET_LEN];
+            size_t len = host_build_packet("CGFC", packet, sizeof(packet));
+            unsigned crc = 0;
+
+            host_write_all(c->fd, packet, len);
+            while(host_read_line(c->fd, line, sizeof(line), 2000) >= 0)
+                if(strncmp(line, "[CGFC:0:", 8) == 0 && sscanf(line + 8, "%X", &crc) == 1) break;
+
+            printf("%s: last frame checksum %04X, expected %04X, %s\n",
+                   c->port, crc, expected, crc == expected ? "match" : "MISMATCH");
+        }
+    }
+
+    for(controller_t* c : controllers) {
+        close(c->fd);
+        delete c;
+    }
+
+    munmap((void*)frames, st.st_size);
+    close(fileFd);
+    return 0;
+}
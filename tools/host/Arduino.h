@@ -0,0 +1,221 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Minimal Arduino API for building the firmware's hardware independent headers (protocol.h) into
+ * Linux host tools. Put this directory ahead of the firmware include directory:
+ *
+ *      g++ -std=c++17 -I tools/host -I include ...
+ *
+ * Each thread has its own Serial and clock so a tool can run several virtual controllers at once.
+ * A thread binds Serial to a file descriptor (usually a PTY master) with HostSerial::bind().
+ * */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <algorithm>
+
+#define HEX 16
+#define DEC 10
+
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Not every libc has strlcpy
+inline size_t host_strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+
+    if(size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+
+    return len;
+}
+
+#define strlcpy host_strlcpy
+
+
+/**
+ * @brief host_clock_us - Monotonic host time in microseconds
+ * @return
+ */
+inline uint64_t host_clock_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+inline thread_local uint64_t host_clock_origin_us = host_clock_us();    // Per thread boot time
+
+inline uint32_t micros() { return (uint32_t)(host_clock_us() - host_clock_origin_us); }
+inline uint32_t millis() { return (uint32_t)((host_clock_us() - host_clock_origin_us) / 1000); }
+inline void delay(uint32_t ms) { usleep(ms * 1000); }
+inline void delayMicroseconds(uint32_t us) { usleep(us); }
+
+
+/* *
+ * HostSerial - Serial port backed by a file descriptor. Reads are buffered from the descriptor
+ * on demand, writes are buffered until flush() so a response goes out in one write, like a USB
+ * packet would.
+ * */
+class HostSerial
+{
+
+private:
+    int m_fd;
+    uint8_t m_rx[1024];
+    size_t m_rxHead;
+    size_t m_rxLen;
+    uint8_t m_tx[4096];
+    size_t m_txLen;
+
+    void fill()
+    {
+        if(m_rxHead < m_rxLen || m_fd < 0) return;
+
+        ssize_t n = ::read(m_fd, m_rx, sizeof(m_rx));
+        m_rxHead = 0;
+        m_rxLen = n > 0 ? n : 0;
+    }
+
+public:
+
+    HostSerial() :
+        m_fd(-1),
+        m_rxHead(0),
+        m_rxLen(0),
+        m_txLen(0)
+    {
+
+    }
+
+    /**
+     * @brief bind - Set the descriptor this serial port reads and writes. It should be non-blocking.
+     * @param fd
+     */
+    void bind(int fd)
+    {
+        m_fd = fd;
+        m_rxHead = m_rxLen = m_txLen = 0;
+    }
+
+    int fd() const { return m_fd; }
+
+    void begin(long) { }
+    explicit operator bool() const { return m_fd >= 0; }
+
+    int available()
+    {
+        fill();
+        return m_rxLen - m_rxHead;
+    }
+
+    int read()
+    {
+        fill();
+        return m_rxHead < m_rxLen ? m_rx[m_rxHead++] : -1;
+    }
+
+    size_t write(uint8_t c)
+    {
+        return write((const char*)&c, 1);
+    }
+
+    size_t write(const char* data, size_t len)
+    {
+        for(size_t i = 0; i < len; i++) {
+            if(m_txLen == sizeof(m_tx)) flush();
+            m_tx[m_txLen++] = data[i];
+        }
+
+        return len;
+    }
+
+    size_t print(const char* s)
+    {
+        return write(s, strlen(s));
+    }
+
+    size_t print(unsigned long value, int base = DEC)
+    {
+        char buff[16];
+        snprintf(buff, sizeof(buff), base == HEX ? "%lX" : "%lu", value);
+        return print(buff);
+    }
+
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return base == DEC ? printf("%d", value) : print((unsigned int)value, base); }
+    size_t println(const char* s) { return print(s) + print("\r\n"); }
+    size_t println() { return print("\r\n"); }
+
+    __attribute__((format(printf, 2, 3)))
+    size_t printf(const char* format, ...)
+    {
+        char buff[256];
+        va_list ap;
+        va_start(ap, format);
+        int n = vsnprintf(buff, sizeof(buff), format, ap);
+        va_end(ap);
+        return n > 0 ? write(buff, min((size_t)n, sizeof(buff) - 1)) : 0;
+    }
+
+    int availableForWrite() const
+    {
+        return sizeof(m_tx) - m_txLen;
+    }
+
+    /**
+     * @brief flush - Write out buffered output, waiting for the descriptor when it is full
+     */
+    void flush()
+    {
+        size_t done = 0;
+
+        while(m_fd >= 0 && done < m_txLen) {
+            ssize_t n = ::write(m_fd, m_tx + done, m_txLen - done);
+            if(n > 0) done += n;
+            else if(n < 0 && errno != EAGAIN && errno != EINTR) break;
+            else usleep(100);
+        }
+
+        m_txLen = 0;
+    }
+
+};
+
+inline thread_local HostSerial host_serial;
+
+#define Serial host_serial
+
+#endif // HOST_ARDUINO_H
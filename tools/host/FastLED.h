@@ -0,0 +1,101 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Minimal FastLED API for building the firmware's pixel headers (readback.h, rings.h) into Linux
+ * host tools. Only CRGB and the 8bit math those headers use, with FastLED's results.
+ * */
+
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+#include <stdint.h>
+
+
+/**
+ * @brief scale8 - Scales a value by scale / 256, 255 leaves it unchanged
+ * @param i
+ * @param scale
+ * @return
+ */
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+/**
+ * @brief qadd8 - Adds two values, saturating at 255
+ * @param i
+ * @param j
+ * @return
+ */
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    uint16_t t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+
+/* *
+ * CRGB - RGB pixel, laid out as 3 bytes like FastLED's
+ * */
+struct CRGB
+{
+    union {
+        struct {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    CRGB() = default;
+
+    constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) { }
+
+    CRGB(uint32_t colorcode) : r(colorcode >> 16), g(colorcode >> 8), b(colorcode) { }
+
+    CRGB& setColorCode(uint32_t colorcode)
+    {
+        r = colorcode >> 16;
+        g = colorcode >> 8;
+        b = colorcode;
+        return *this;
+    }
+
+    uint8_t& operator[](uint8_t x) { return raw[x]; }
+    const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+
+    CRGB& operator+=(const CRGB& rhs)
+    {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+
+    CRGB& nscale8(uint8_t scale)
+    {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+};
+
+#endif // HOST_FASTLED_H
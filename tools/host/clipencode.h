@@ -0,0 +1,223 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Host side encoder for the clip format in clip.h.
+ * */
+
+#ifndef HOST_CLIPENCODE_H
+#define HOST_CLIPENCODE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <vector>
+#include "clip.h"
+
+
+/* *
+ * ClipPalette - Maps RGB colors to palette indexes
+ * */
+class ClipPalette
+{
+
+private:
+    std::map<uint32_t, uint8_t> m_index;
+    std::vector<uint8_t> m_rgb;
+
+public:
+
+    /**
+     * @brief build - Builds a palette of every color in a set of frames
+     * @param rgb - Frames, 3 bytes per pixel
+     * @param len - Length of rgb
+     * @return false when there are more than 256 colors
+     */
+    bool build(const uint8_t* rgb, size_t len)
+    {
+        m_index.clear();
+        m_rgb.clear();
+
+        for(size_t i = 0; i + 2 < len; i += 3) {
+
+            uint32_t color = (rgb[i] << 16) | (rgb[i + 1] << 8) | rgb[i + 2];
+
+            if(m_index.count(color)) continue;
+            if(m_index.size() == 256) return false;
+
+            uint8_t index = m_index.size();
+            m_index[color] = index;
+            m_rgb.insert(m_rgb.end(), rgb + i, rgb + i + 3);
+        }
+
+        return true;
+    }
+
+    uint8_t index(const uint8_t* rgb) const
+    {
+        return m_index.at((rgb[0] << 16) | (rgb[1] << 8) | rgb[2]);
+    }
+
+    size_t count() const
+    {
+        return m_index.size();
+    }
+
+    const std::vector<uint8_t>& rgb() const
+    {
+        return m_rgb;
+    }
+
+};
+
+
+/**
+ * @brief clip_encode_pixel - Appends a stored pixel
+ * @param out
+ * @param rgb
+ * @param palette - Palette or nullptr for RGB
+ */
+inline void clip_encode_pixel(std::vector<uint8_t>* out, const uint8_t* rgb, const ClipPalette* palette) {
+    if(palette) out->push_back(palette->index(rgb));
+    else out->insert(out->end(), rgb, rgb + 3);
+}
+
+/**
+ * @brief clip_encode_frame - Encodes one frame
+ * @param out - Encoded frame is appended
+ * @param frame - Frame, 3 bytes per pixel
+ * @param prev - Previous frame for a delta frame, or nullptr for a key frame
+ * @param pixels - Pixels per frame
+ * @param palette - Palette or nullptr for RGB
+ */
+inline void clip_encode_frame(std::vector<uint8_t>* out, const uint8_t* frame, const uint8_t* prev,
+                              uint16_t pixels, const ClipPalette* palette) {
+
+    // Runs shorter than these cost more as their own op than as part of a literal
+    const uint16_t minRepeat = palette ? 3 : 2;
+    const uint16_t minSkip = palette ? 2 : 1;
+
+    auto same = [&](uint16_t a, uint16_t b) { return memcmp(&frame[a * 3], &frame[b * 3], 3) == 0; };
+    auto unchanged = [&](uint16_t p) { return prev && memcmp(&frame[p * 3], &prev[p * 3], 3) == 0; };
+
+    auto repeatRun = [&](uint16_t p) {
+        uint16_t n = 1;
+        while(p + n < pixels && n < CLIP_MAX_RUN && same(p, p + n)) n++;
+        return n;
+    };
+
+    auto skipRun = [&](uint16_t p) {
+        uint16_t n = 0;
+        while(p + n < pixels && n < CLIP_MAX_RUN && unchanged(p + n)) n++;
+        return n;
+    };
+
+    out->push_back(prev ? CLIP_FRAME_DELTA : CLIP_FRAME_KEY);
+
+    uint16_t p = 0;
+    while(p < pixels) {
+
+        uint16_t skip = skipRun(p);
+        if(skip >= minSkip) {
+            out->push_back(CLIP_OP_SKIP | (skip - 1));
+            p += skip;
+            continue;
+        }
+
+        uint16_t repeat = repeatRun(p);
+        if(repeat >= minRepeat) {
+            out->push_back(CLIP_OP_REPEAT | (repeat - 1));
+            clip_encode_pixel(out, &frame[p * 3], palette);
+            p += repeat;
+            continue;
+        }
+
+        // Literal until a run worth its own op starts
+        uint16_t start = p;
+        p++;
+        while(p < pixels && p - start < CLIP_MAX_RUN && skipRun(p) < minSkip && repeatRun(p) < minRepeat)
+            p++;
+
+        out->push_back(CLIP_OP_LITERAL | (p - start - 1));
+        for(uint16_t i = start; i < p; i++) clip_encode_pixel(out, &frame[i * 3], palette);
+    }
+}
+
+/**
+ * @brief clip_encode - Encodes a clip
+ * @param frames - Frames, 3 bytes per pixel
+ * @param count - Number of frames
+ * @param pixels - Pixels per frame
+ * @param frameMs - Frame interval
+ * @param usePalette - Use a palette when the clip has 256 colors or less
+ * @param keyInterval - Force a key frame every keyInterval frames, 0 only uses key frames where
+ * they are smaller than the delta frame
+ * @param keyFrames - Set to the number of key frames
+ * @return Encoded clip
+ */
+inline std::vector<uint8_t> clip_encode(const uint8_t* frames, uint16_t count, uint16_t pixels, uint16_t frameMs,
+                                        bool usePalette, uint16_t keyInterval, uint16_t* keyFrames) {
+
+    const size_t frameLen = pixels * 3;
+    ClipPalette palette;
+    bool paletted = usePalette && palette.build(frames, frameLen * count);
+
+    std::vector<uint8_t> out;
+    out.reserve(frameLen * count + 256 * 3);
+    out.resize(CLIP_HEADER_LEN, 0);
+    memcpy(&out[0], CLIP_MAGIC, 4);
+    out[4] = CLIP_VERSION;
+    out[5] = paletted ? CLIP_FLAG_PALETTE : 0;
+    out[6] = pixels & 0xFF;
+    out[7] = pixels >> 8;
+    out[8] = count & 0xFF;
+    out[9] = count >> 8;
+    out[10] = frameMs & 0xFF;
+    out[11] = frameMs >> 8;
+
+    if(paletted) {
+        out[12] = palette.count() & 0xFF;
+        out[13] = palette.count() >> 8;
+        out.insert(out.end(), palette.rgb().begin(), palette.rgb().end());
+    }
+
+    *keyFrames = 0;
+
+    for(uint16_t f = 0; f < count; f++) {
+
+        const uint8_t* frame = &frames[f * frameLen];
+        std::vector<uint8_t> key, delta;
+
+        clip_encode_frame(&key, frame, nullptr, pixels, paletted ? &palette : nullptr);
+
+        if(f > 0 && (keyInterval == 0 || f % keyInterval != 0))
+            clip_encode_frame(&delta, frame, frame - frameLen, pixels, paletted ? &palette : nullptr);
+
+        if(delta.empty() || key.size() <= delta.size()) {
+            out.insert(out.end(), key.begin(), key.end());
+            (*keyFrames)++;
+        } else {
+            out.insert(out.end(), delta.begin(), delta.end());
+        }
+    }
+
+    return out;
+}
+
+#endif // HOST_CLIPENCODE_H
@@ -0,0 +1,186 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * Serial port, PTY and timing helpers shared by the Linux host tools.
+ * */
+
+#ifndef HOST_HOSTPORT_H
+#define HOST_HOSTPORT_H
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <algorithm>
+#include <vector>
+#include "protocol.h"
+
+
+/**
+ * @brief host_set_raw - Puts a tty in raw mode so protocol bytes pass through untouched
+ * @param fd
+ * @return false on error
+ */
+inline bool host_set_raw(int fd) {
+    struct termios tio;
+
+    if(tcgetattr(fd, &tio) != 0) return false;
+
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+/**
+ * @brief host_open_port - Opens a serial port or PTY in raw mode
+ * @param path
+ * @return File descriptor or -1 on error
+ */
+inline int host_open_port(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if(fd >= 0 && isatty(fd) && !host_set_raw(fd)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief host_open_pty - Opens a raw mode PTY pair. The slave is kept open by the caller so reads
+ * of the master don't fail while no client has the port open.
+ * @param master - Set to the non-blocking master descriptor
+ * @param slave - Set to the slave descriptor
+ * @param name - Set to the slave device path
+ * @param nameLen - Size of name
+ * @return false on error
+ */
+inline bool host_open_pty(int* master, int* slave, char* name, size_t nameLen) {
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if(*master < 0) return false;
+
+    if(grantpt(*master) != 0 || unlockpt(*master) != 0 || ptsname_r(*master, name, nameLen) != 0) {
+        close(*master);
+        return false;
+    }
+
+    *slave = host_open_port(name);
+
+    if(*slave < 0) {
+        close(*master);
+        return false;
+    }
+
+    fcntl(*master, F_SETFL, fcntl(*master, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+/**
+ * @brief host_write_all - Writes the whole buffer, waiting for the descriptor when it is full
+ * @param fd
+ * @param data
+ * @param len
+ * @return false on error
+ */
+inline bool host_write_all(int fd, const char* data, size_t len) {
+    while(len > 0) {
+        ssize_t n = write(fd, data, len);
+
+        if(n > 0) {
+            data += n;
+            len -= n;
+        } else if(n < 0 && errno != EAGAIN && errno != EINTR) {
+            return false;
+        } else {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            poll(&pfd, 1, 100);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief host_build_packet - Frames a command as a protocol packet with its CRC16
+ * @param body - Command and params, e.g. "CSC:FF0000"
+ * @param out - Packet output
+ * @param outLen - Size of out
+ * @return Packet length
+ */
+inline size_t host_build_packet(const char* body, char* out, size_t outLen) {
+    int n = snprintf(out, outLen, "%c%s%c", PROTO_STX, body, PROTO_ETX);
+
+    if(n < 0 || (size_t)n + 6 > outLen) return 0;
+
+    uint16_t crc = crc16_buffer(0, out, 0, n);
+    return n + snprintf(out + n, outLen - n, "%04X%c", crc, PROTO_CR);
+}
+
+/**
+ * @brief host_read_line - Reads up to and including the next CR
+ * @param fd
+ * @param out - Line output, NUL terminated without the CR
+ * @param outLen - Size of out
+ * @param timeoutMs - Max time to wait
+ * @return Line length or -1 on timeout or error
+ */
+inline int host_read_line(int fd, char* out, size_t outLen, int timeoutMs) {
+    size_t len = 0;
+    uint64_t deadline = host_clock_us() + (uint64_t)timeoutMs * 1000;
+
+    while(true) {
+        int64_t left = (int64_t)(deadline - host_clock_us());
+        struct pollfd pfd = { fd, POLLIN, 0 };
+
+        if(left <= 0 || poll(&pfd, 1, (int)((left + 999) / 1000)) <= 0) return -1;
+
+        char c;
+        ssize_t n = read(fd, &c, 1);
+
+        if(n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        if(n <= 0) return -1;
+        if(c == PROTO_NL) continue;
+
+        if(c == PROTO_CR) {
+            out[len] = 0;
+            return len;
+        }
+
+        if(len + 1 < outLen) out[len++] = c;
+    }
+}
+
+/**
+ * @brief host_percentile - Gets a percentile of a set of samples, sorting them in place
+ * @param samples
+ * @param pct - 0 to 100
+ * @return
+ */
+inline uint32_t host_percentile(std::vector<uint32_t>& samples, double pct) {
+    if(samples.empty()) return 0;
+
+    size_t index = std::min(samples.size() - 1, (size_t)(pct / 100.0 * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+#endif // HOST_HOSTPORT_H
@@ -0,0 +1,1443 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * loadsim - Runs a fleet of virtual LED strip controllers on one Linux host so host software can
+ * be load tested against many controllers at once.
+ *
+ * Each controller runs on its own thread with its own PTY, clock and a thread local copy of the
+ * firmware's state. Controllers answer the firmware's command table from commands.h, so the
+ * commands, param specs, coalescing and FEATURE_* build flags are the firmware's, and run the
+ * firmware's input framing, coalesced command queue and handlers with the EEPROM left out. Effects
+ * are not rendered, a frame is filled with the solid color or the streamed frame and
+ * FastLED.show() is modelled as a blocking wait of the WS2812 wire time, so input is held off
+ * while a frame is shown just like on the Teensy.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -pthread -I tools/host -I include tools/loadsim/loadsim.cpp -o loadsim
+ *
+ * Usage
+ *      loadsim [-n instances] [-t seconds] [-l link dir] [-d] [-r rate] [-L leds] [-f frame ms] [-v]
+ *
+ *      -n  Number of controllers (default 100)
+ *      -t  Seconds to run, 0 runs until Ctrl-C (default 0, 10 with -d)
+ *      -l  Directory to create ledsim<N> links to each controller's PTY in
+ *      -d  Drive the controllers with a built in host, one thread per controller
+ *      -r  Commands per second per controller for -d, 0 sends as fast as responses come back
+ *      -L  LEDs per controller, the longest strip CSL can set (default 300). The strip length
+ *          sets the modelled show time.
+ *      -f  Frame interval in ms (default 16)
+ *      -v  Print stats for every controller
+ *
+ * Controller stats show how busy each controller was and how long it waited on the host between
+ * sending a response and receiving the next packet. Host stats (-d) show the round trip latency
+ * of each command and the aggregate throughput. When controllers are mostly idle while latency
+ * grows with the instance count, the host is the bottleneck.
+ * */
+
+#define MAX_LEDS                    4096                    // Max -L, sizes the per controller buffers
+
+#include <Arduino.h>
+#include "commands.h"
+#include "protocol.h"
+#include "protostats.h"
+#include "clip.h"
+#include "clips.h"
+#include "fade.h"
+#include "interpolator.h"
+#include "readback.h"
+#include "recorder.h"
+#include "rings.h"
+#include "tempo.h"
+#include "hostport.h"
+
+#include <signal.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define MAX_INPUT_BUFFER_LEN        MAX_PROTO_PACKET_LEN    // Input buffer max length
+#define MAX_PACKETS_PER_PASS        16                      // Max packets handled between frames
+#define MIN_FORCED_RENDER_INTERVAL_MS   5                   // Min time between renders forced by state changing commands
+#define READBACK_CHUNK_CHARS        192                     // Max HEX characters in one frame readback chunk
+#define PACKET_RECORDER_SIZE        4096                    // Bytes kept for recording received packets
+#define WS2812_US_PER_LED           30                      // 24 bits at 800kHz
+#define WS2812_LATCH_US             50                      // Reset time after a frame
+
+const char* VERSION_CODE = "LEDSC_TEENSY_001";
+
+static std::atomic<bool> running(true);
+
+
+/* *
+ * Options
+ * */
+typedef struct options_struct
+{
+    int instances = 100;
+    int seconds = -1;
+    const char* linkDir = nullptr;
+    bool drive = false;
+    int rate = 0;
+    int leds = 300;
+    int frameMs = 16;
+    bool verbose = false;
+} options_t;
+
+static options_t options;
+
+
+/* *
+ * Controller side stats
+ * */
+typedef struct controller_stats_struct
+{
+    uint64_t packets = 0;                   // Packets handled
+    uint64_t errors = 0;                    // Error responses sent
+    uint64_t frames = 0;                    // Frames shown
+    uint64_t presents = 0;                  // Streamed frames presented
+    uint64_t serviceUs = 0;                 // Time spent handling packets
+    uint32_t serviceMaxUs = 0;              // Longest time handling a packet
+    uint64_t showUs = 0;                    // Time spent showing frames
+    uint64_t hostWaitUs = 0;                // Time between a response and the next packet, less show time
+    uint64_t hostWaits = 0;                 // Number of host waits measured
+} controller_stats_t;
+
+
+/* *
+ * Firmware state. Every controller thread has its own copy, the handlers below work on the
+ * copy of the controller they run on.
+ * */
+thread_local controller_stats_t* controllerStats = nullptr;        // Stats of this thread's controller
+thread_local CRGB leds[MAX_LEDS];                                   // Frame buffer
+thread_local uint16_t numLeds = 0;                                  // Active strip length
+thread_local CRGB color(175,91,7);                                  // Base color for effects that require an input color
+thread_local uint8_t brightness = 0x44;                             // 0-255 LED brightness
+thread_local Effect_t active_effect = AvailableEffects::SOLID_COLOR;    // Active LED Strip effect
+thread_local uint8_t fireColorPallet = 0;                           // Current fire color pallet
+thread_local CRGB customPallet[16];                                 // Custom fire color pallet
+thread_local bool debugging = false;                                // Enable debugging output
+thread_local FrameReadback<MAX_LEDS> frameReadback;                 // Frame readback in progress
+thread_local PacketRecorder<PACKET_RECORDER_SIZE> packetRecorder;   // Received packet recording
+thread_local uint8_t activeClip = 0;                                // Clip played by the clip effect
+thread_local CRGB streamFrame[MAX_LEDS];                            // Streamed frame being written
+thread_local bool streamPresented = false;                          // Stream frame ready to be shown
+thread_local FrameInterpolator<MAX_LEDS> streamInterpolator;        // Blends streamed frames while interpolating
+thread_local TempoClock tempo;                                      // Beat clock for tempo synced effects
+thread_local bool tempoSync = false;                                // Lock effects that follow the tempo to the beat
+thread_local bool beatRenderDue = false;                            // A beat started, render it on the next loop pass
+thread_local uint32_t ringCodes[MAX_RINGS];                         // Rings set with Set Rings
+thread_local uint8_t ringCount = 0;                                 // Number of rings
+thread_local uint32_t clockSeconds = 0;                             // Time of day the clock was set to
+thread_local uint32_t clockSetMs = 0;                               // Time the clock was set
+thread_local FadeChannel fadeBrightness;                            // Brightness fade
+thread_local FadeChannel fadeColor[3];                              // Color fade, per channel
+thread_local uint8_t fadeFrame = 0;                                 // Frames shown, picks each frame's dithering
+thread_local bool effectClockFrozen = false;                        // Effect clock is frozen, only Frame Step renders
+thread_local uint32_t effectClockFrozenMs = 0;                      // Effect clock time while frozen
+thread_local uint32_t effectClockOffsetMs = 0;                      // Time spent frozen
+thread_local uint16_t framesToStep = 0;                             // Frames left to render while frozen
+thread_local uint16_t frameNumber = 0;                              // Frames shown, wraps, tags readbacks and checksums
+thread_local char char_in_buffer[MAX_INPUT_BUFFER_LEN];             // Input character buffer
+thread_local proto_framer_t input_framer;                           // Frames char_in_buffer into packets
+thread_local proto_pkt_t pkt_receive;                               // Command protocol receive packet
+thread_local proto_rsp_t pkt_response;                              // Command protocol response packet
+thread_local uint32_t pktReceivedUs = 0;                            // Time the last packet was received
+thread_local pending_cmd_t cmd_pending[COMMAND_COUNT];              // Newest waiting packet for each coalesced command
+thread_local uint8_t cmd_pending_count = 0;                         // Number of waiting packets
+thread_local uint32_t cmd_pending_seq = 0;                          // Arrival order of the next queued packet
+thread_local ProtoStats<COMMAND_COUNT> protoStats;                  // Command protocol counters
+thread_local bool render_requested = false;                         // Visible state changed, show it on the next loop pass
+thread_local bool redraw_requested = false;                         // The change needs the frame drawn again to show
+thread_local uint32_t cmdReceivedUs = 0;                            // Receipt time of the oldest command waiting for a render
+thread_local uint32_t cmdLatencyUs = 0;                             // Last command receipt to show latency
+thread_local uint32_t cmdLatencyMaxUs = 0;                          // Max command receipt to show latency since last read
+thread_local uint32_t showUs = 0;                                   // Time the last frame took to show
+
+
+/**
+ * @brief effect_clock_ms - Effect clock, stops while frozen like the firmware's EffectClockMs()
+ * @return
+ */
+uint32_t effect_clock_ms() {
+    return effectClockFrozen ? effectClockFrozenMs : millis() - effectClockOffsetMs;
+}
+
+/**
+ * @brief freeze_effect_clock - Stops or restarts the effect clock, restarting continues from the
+ * frozen time
+ * @param freeze
+ */
+void freeze_effect_clock(bool freeze) {
+
+    if(freeze == effectClockFrozen) return;
+
+    if(freeze) effectClockFrozenMs = effect_clock_ms();
+    else effectClockOffsetMs = millis() - effectClockFrozenMs;
+
+    effectClockFrozen = freeze;
+}
+
+/**
+ * @brief request_show - Requests the current frame is shown again on the next loop pass
+ */
+void request_show() {
+
+    if(!render_requested) cmdReceivedUs = pktReceivedUs;
+    render_requested = true;
+}
+
+/**
+ * @brief request_render - Requests the active effect is drawn and shown on the next loop pass
+ */
+void request_render() {
+
+    request_show();
+    redraw_requested = true;
+}
+
+/**
+ * @brief request_color_render - Requests a color change is shown, Solid Color is drawn again
+ */
+void request_color_render() {
+
+    if(active_effect == AvailableEffects::SOLID_COLOR) request_render();
+    else request_show();
+}
+
+/**
+ * @brief tempo_synced - Get whether an effect is locked to the beat
+ * @param effect
+ * @return true if tempo sync is on and the effect follows the tempo
+ */
+bool tempo_synced(Effect_t effect) {
+
+    if(!FEATURE_TEMPO || !tempoSync) return false;
+
+    switch(effect)
+    {
+    case AvailableEffects::RAINBOW_CYCLE:
+    case AvailableEffects::COMET:
+    case AvailableEffects::COMET_RAINBOW:
+    case AvailableEffects::SOLID_PULSE:
+    case AvailableEffects::SPINNER:
+    case AvailableEffects::RADAR:
+        return true;
+
+    default:
+        return false;
+    };
+}
+
+/**
+ * @brief on_tempo_event - Tempo listener, renders each beat as it starts
+ * @param events
+ * @param beat
+ */
+void on_tempo_event(uint8_t events, uint16_t beat) {
+
+    if(tempo_synced(active_effect)) beatRenderDue = true;
+}
+
+/**
+ * @brief fading - Get whether a brightness or color fade is running
+ * @return
+ */
+bool fading() {
+    return fadeBrightness.active() || fadeColor[0].active() || fadeColor[1].active() || fadeColor[2].active();
+}
+
+/**
+ * @brief update_fades - Advances the brightness and color fades and sets this frame's dithered
+ * levels
+ */
+void update_fades() {
+
+    if(!fading()) return;
+
+    uint32_t now = effect_clock_ms();
+    fadeFrame++;
+
+    if(fadeBrightness.active()) {
+        fadeBrightness.update(now);
+        brightness = fadeBrightness.level();
+    }
+
+    for(uint8_t c = 0; c < 3; c++) {
+        if(fadeColor[c].active()) {
+            fadeColor[c].update(now);
+            color[c] = fadeColor[c].dithered(fadeFrame);
+        }
+    }
+}
+
+/**
+ * @brief render_effect - Fills the frame buffer with the solid color, or the presented or
+ * interpolated stream frame
+ */
+void render_effect() {
+
+    if(active_effect == AvailableEffects::STREAM) {
+
+        if(streamInterpolator.mode() != INTERPOLATE_OFF) {
+            if(streamPresented) {
+                streamInterpolator.present((uint8_t*)leds, (uint8_t*)streamFrame, numLeds, effect_clock_ms(), false, 0);
+                streamPresented = false;
+            }
+            streamInterpolator.render((uint8_t*)leds, numLeds, effect_clock_ms());
+        } else if(streamPresented) {
+            memcpy(leds, streamFrame, numLeds * sizeof(CRGB));
+            streamPresented = false;
+        }
+
+    } else {
+
+        CRGB fill = active_effect == AvailableEffects::OFF ? CRGB(0, 0, 0) : color;
+        for(uint16_t i = 0; i < numLeds; i++) leds[i] = fill;
+    }
+}
+
+/**
+ * @brief render_frame - Renders a frame and waits out the time FastLED.show() would take
+ * @param draw - Render the effect. When false the current frame buffer is only shown again.
+ */
+void render_frame(bool draw) {
+
+    update_fades();
+
+    if(draw) {
+        tempo.update(effect_clock_ms());
+        render_effect();
+        beatRenderDue = false;
+    }
+
+    if(render_requested) {
+        render_requested = false;
+        redraw_requested = false;
+        cmdLatencyUs = micros() - cmdReceivedUs;
+        cmdLatencyMaxUs = max(cmdLatencyMaxUs, cmdLatencyUs);
+    }
+
+    uint32_t start = micros();
+    delayMicroseconds(numLeds * WS2812_US_PER_LED + WS2812_LATCH_US);
+    showUs = micros() - start;
+    frameNumber++;
+
+    controllerStats->showUs += showUs;
+    controllerStats->frames++;
+}
+
+/**
+ * @brief readback_scale - Gets the per channel scale for a frame readback source. The output is
+ * only scaled by brightness, there is no power limiting or color correction to model.
+ * @param source
+ * @return
+ */
+CRGB readback_scale(uint8_t source) {
+
+    if(source != AvailableReadbackSources::FrameOutput) return CRGB(255, 255, 255);
+    return CRGB(brightness, brightness, brightness);
+}
+
+/**
+ * @brief proc_print_error
+ * @param pkt_received
+ * @param pkt_response
+ * @param errorcode
+ */
+void proc_print_error(const proto_pkt_t* pkt_received, proto_rsp_t* pkt_response, int16_t errorcode) {
+    proto_init_response_pkt(pkt_response, pkt_received);
+    proto_set_response_pkt_error_code(pkt_response, errorcode);
+    proto_print_response_pkt(pkt_response);
+    controllerStats->errors++;
+}
+
+void proc_not_implemented(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_CMD_NOT_IMP);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_print_version(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, VERSION_CODE);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_debugging(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    if(argc > 0)
+        debugging = args[0].u32 != 0;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_active_effect(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint8_t effectin = args[0].u8;
+
+    if(effect_available(effectin)) {
+        if(effectin != active_effect && effectin == AvailableEffects::STREAM) streamInterpolator.reset();
+        active_effect = (Effect_t)effectin;
+        request_render();
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_color(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    color.setColorCode(args[0].u32);
+    for(uint8_t c = 0; c < 3; c++) fadeColor[c].set(color[c]);
+    request_color_render();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_brightness(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    brightness = args[0].u8;
+    fadeBrightness.set(brightness);
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_fire_color_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    fireColorPallet = args[0].u8;
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_custom_pallet(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    for(uint8_t i=0; i<16; i++)
+        customPallet[i] = CRGB(args[i * argc / 16].u32);
+
+    request_show();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_status(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    snprintf(buff, sizeof(buff),
+             "%02X|%02X|%02X|%02X%02X%02X|%02X|%04X",
+             debugging,
+             (uint16_t)active_effect,
+             brightness,
+             color.r, color.g, color.b,
+             FEATURE_FIRE_COLOR ? fireColorPallet : 0,
+             numLeds);
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    uint8_t source = argc > 0 ? args[0].u8 : (uint8_t)AvailableReadbackSources::FrameBuffer;
+    uint8_t encoding = argc > 1 ? args[1].u8 : (uint8_t)AvailableReadbackEncodings::RleRGB888;
+    uint8_t downsample = argc > 2 ? args[2].u8 : 1;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(source >= AvailableReadbackSources::MaxReadbackSource
+            || encoding >= AvailableReadbackEncodings::MaxReadbackEncoding
+            || downsample == 0) {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    frameReadback.begin(leds, numLeds, (ReadbackEncoding_t)encoding, downsample, readback_scale(source));
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    snprintf(buff, sizeof(buff), "%04X|%04X", frameReadback.pixelCount(), frameNumber);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_frame_readback_chunk - Sends the next chunk of the frame readback in progress
+ */
+void proc_frame_readback_chunk() {
+
+    char chunk[READBACK_CHUNK_CHARS];
+    uint16_t firstPixel = 0;
+    uint16_t len = frameReadback.nextChunk(chunk, READBACK_CHUNK_CHARS, &firstPixel);
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    snprintf(buff, sizeof(buff), "%04X", firstPixel);
+
+    proto_init_response_pkt(&pkt_response, CMD_GET_FRAME);
+    proto_append_response_pkt_param(&pkt_response, buff);
+    proto_set_response_pkt_payload(&pkt_response, chunk, len);
+    proto_print_response_pkt(&pkt_response);
+}
+
+void proc_get_frame_checksum(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    uint8_t source = argc > 0 ? args[0].u8 : (uint8_t)AvailableReadbackSources::FrameBuffer;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(source >= AvailableReadbackSources::MaxReadbackSource) {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    char buff[MAX_PROTO_PARAM_LEN];
+    snprintf(buff, sizeof(buff), "%04X|%04X|%04X", frame_checksum(leds, numLeds, readback_scale(source)), numLeds, frameNumber);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_telemetry(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    snprintf(buff, sizeof(buff),
+             "%08X|%08X|%04X|%08X|%08X|%04X",
+             (unsigned)cmdLatencyUs,
+             (unsigned)cmdLatencyMaxUs,
+             1000 / options.frameMs,
+             0u,
+             (unsigned)showUs,
+             (unsigned)options.frameMs);
+
+    cmdLatencyMaxUs = 0;
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_freeze(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    // Nothing rendered is random, a seed is only accepted
+    freeze_effect_clock(args[0].u8 != 0);
+    framesToStep = 0;
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_frame_step(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    freeze_effect_clock(true);
+    framesToStep = argc > 0 ? args[0].u16 : 1;
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8) packetRecorder.start(micros());
+    else packetRecorder.stop();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_recording(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(argc == 0) {
+
+        snprintf(buff, sizeof(buff),
+                 "%04X|%04X|%02X",
+                 packetRecorder.count(),
+                 packetRecorder.dropped(),
+                 packetRecorder.recording());
+
+        proto_append_response_pkt_param(pkt_response, buff);
+
+    } else {
+
+        uint32_t timeUs;
+        uint16_t len;
+        const char* body = packetRecorder.get(args[0].u16, &timeUs, &len);
+
+        if(body != nullptr) {
+            snprintf(buff, sizeof(buff), "%08X", (unsigned)timeUs);
+            proto_append_response_pkt_param(pkt_response, buff);
+            proto_set_response_pkt_payload(pkt_response, body, len);
+        } else {
+            proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+        }
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_clip(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8 < CLIP_COUNT) {
+        activeClip = args[0].u8;
+        if(active_effect == AvailableEffects::CLIP) request_render();
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_write_frame(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint16_t first = args[0].u16;
+    uint8_t flags = args[1].u8;
+    const char* hex = argc > 2 ? pkt_receive.buffer + args[2].slice.offset : nullptr;
+    uint16_t hexLen = argc > 2 ? args[2].slice.len : 0;
+    int16_t error_code = ERR_PROTO_SUCCESS;
+
+    if(first > numLeds) {
+
+        error_code = ERR_PROTO_CP_PARAM_OUT_RANGE;
+
+    } else if(flags & WRITE_FRAME_DELTA) {
+
+        uint8_t ops[MAX_PROTO_PACKET_LEN / 2];
+        uint16_t len = hexLen / 2;
+        uint32_t value;
+
+        for(uint16_t i=0; i<len && error_code == ERR_PROTO_SUCCESS; i++) {
+            error_code = proto_parse_hex(hex + i * 2, 2, 0xFF, &value);
+            if(error_code == ERR_PROTO_SUCCESS) ops[i] = value;
+        }
+
+        if(error_code == ERR_PROTO_SUCCESS
+                && (hexLen % 2 != 0 || ClipDecoder::applyOps(ops, len, (uint8_t*)streamFrame, first, numLeds) < 0))
+            error_code = ERR_PROTO_CP_PARAM_INVALID;
+
+    } else {
+
+        uint16_t count = hexLen / 6;
+        uint32_t value;
+
+        if(hexLen % 6 != 0) error_code = ERR_PROTO_CP_PARAM_INVALID;
+        else if(first + count > numLeds) error_code = ERR_PROTO_CP_PARAM_OUT_RANGE;
+
+        for(uint16_t i=0; i<count && error_code == ERR_PROTO_SUCCESS; i++) {
+            error_code = proto_parse_hex(hex + i * 6, 6, 0xFFFFFF, &value);
+            if(error_code == ERR_PROTO_SUCCESS) streamFrame[first + i].setColorCode(value);
+        }
+    }
+
+    if(error_code != ERR_PROTO_SUCCESS) {
+        proto_set_response_pkt_error_code(pkt_response, error_code);
+    } else if(flags & WRITE_FRAME_PRESENT) {
+
+        if(active_effect == AvailableEffects::STREAM && streamInterpolator.mode() != INTERPOLATE_OFF) {
+            streamInterpolator.present((uint8_t*)leds, (uint8_t*)streamFrame, numLeds, effect_clock_ms(),
+                                       argc > 3, argc > 3 ? args[3].u32 : 0);
+        } else {
+            streamPresented = true;
+        }
+
+        controllerStats->presents++;
+        if(active_effect == AvailableEffects::STREAM) request_render();
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_interpolation(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u8 < INTERPOLATE_MODES) streamInterpolator.setMode(args[0].u8);
+    else proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_length(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    // -L stands in for the firmware's MAX_LEDS
+    if(args[0].u16 >= MIN_LEDS && args[0].u16 <= options.leds) {
+
+        if(args[0].u16 != numLeds) {
+            memset(leds, 0, sizeof(leds));
+            numLeds = args[0].u16;
+            streamInterpolator.reset();
+            request_render();
+        }
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint8_t beatsPerBar = argc > 2 ? args[2].u8 : tempo.beatsPerBar();
+
+    if(args[0].u16 >= TEMPO_MIN_BPM && args[0].u16 <= TEMPO_MAX_BPM
+            && beatsPerBar > 0 && beatsPerBar <= TEMPO_MAX_BEATS_PER_BAR) {
+
+        tempo.update(effect_clock_ms());
+        tempo.setBpm(args[0].u16);
+        tempo.setBeatsPerBar(beatsPerBar);
+        if(argc > 1) tempo.setPhase(args[1].u16, effect_clock_ms());
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_tap_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    tempo.tap(effect_clock_ms());
+    if(tempo_synced(active_effect)) request_render();
+
+    snprintf(buff, sizeof(buff), "%04X", tempo.bpm());
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_tempo_sync(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    tempoSync = args[0].u8 != 0;
+    request_render();
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_tempo(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    tempo.update(effect_clock_ms());
+
+    snprintf(buff, sizeof(buff),
+             "%04X|%02X|%04X|%02X|%04X|%02X",
+             tempo.bpm(),
+             tempo.beatsPerBar(),
+             tempo.beat(),
+             tempo.beatInBar(),
+             tempo.beatPhase(),
+             tempoSync);
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+    proto_append_response_pkt_param(pkt_response, buff);
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_rings(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    uint32_t codes[MAX_RINGS];
+    uint16_t total = 0;
+    bool valid = argc <= MAX_RINGS;
+
+    for(uint8_t i = 0; valid && i < argc; i++) {
+        codes[i] = args[i].u32;
+        total += codes[i] >> 24;
+        valid = ring_code_valid(codes[i]) && total <= options.leds;
+    }
+
+    if(valid) {
+        memcpy(ringCodes, codes, argc * sizeof(uint32_t));
+        ringCount = argc;
+        request_render();
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_set_time(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u32 < SECONDS_PER_DAY) {
+
+        clockSeconds = args[0].u32;
+        clockSetMs = millis();
+        if(active_effect == AvailableEffects::CLOCK) request_render();
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_fade(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(args[0].u32 <= FADE_MAX_MS) {
+
+        uint32_t now = effect_clock_ms();
+
+        if(!fadeBrightness.active()) fadeBrightness.set(brightness);
+        fadeBrightness.start(args[1].u8, args[0].u32, now);
+
+        if(argc > 2) {
+            CRGB target(args[2].u32);
+            for(uint8_t c = 0; c < 3; c++) fadeColor[c].start(target[c], args[0].u32, now);
+        }
+
+        request_color_render();
+
+    } else {
+        proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    }
+
+    proto_print_response_pkt(pkt_response);
+}
+
+void proc_get_proto_stats(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc, proto_rsp_t* pkt_response) {
+
+    char buff[MAX_PROTO_PARAM_LEN];
+
+    proto_init_response_pkt(pkt_response, cmd->name);
+
+    if(argc == 0) {
+
+        snprintf(buff, sizeof(buff),
+                 "%08X|%08X|%08X|%08X|%08X",
+                 (unsigned)protoStats.bytes(),
+                 (unsigned)protoStats.packets(),
+                 (unsigned)protoStats.overflows(),
+                 (unsigned)protoStats.errors(ERR_PROTO_CP_CRC16_MISMATCH),
+                 (unsigned)input_framer.wasted);
+        proto_append_response_pkt_param(pkt_response, buff);
+
+        char errors[PROTO_STATS_ERROR_COUNT * 9];
+        uint16_t len = 0;
+        for(int16_t code = PROTO_STATS_FIRST_ERROR; code >= PROTO_STATS_LAST_ERROR; code--)
+            len += snprintf(errors + len, sizeof(errors) - len, len > 0 ? "|%08X" : "%08X", (unsigned)protoStats.errors(code));
+        proto_set_response_pkt_payload(pkt_response, errors, len);
+
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    const char* name = pkt_receive.buffer + args[0].slice.offset;
+    uint16_t len = args[0].slice.len;
+
+    for(uint8_t i = 0; i < COMMAND_COUNT; i++) {
+
+        if(strlen(COMMANDS[i].name) != len || strncmp(COMMANDS[i].name, name, len) != 0) continue;
+
+        const proto_cmd_stats_t& cmdStats = protoStats.commandStats(i);
+        snprintf(buff, sizeof(buff),
+                 "%08X|%08X|%08X",
+                 (unsigned)cmdStats.count,
+                 (unsigned)cmdStats.handlerUs,
+                 (unsigned)cmdStats.handlerMaxUs);
+        proto_append_response_pkt_param(pkt_response, buff);
+        proto_print_response_pkt(pkt_response);
+        return;
+    }
+
+    proto_set_response_pkt_error_code(pkt_response, ERR_PROTO_CP_PARAM_OUT_RANGE);
+    proto_print_response_pkt(pkt_response);
+}
+
+/**
+ * @brief proc_input - The firmware's proc_input(), frames serial input into pkt_received
+ * @return Packet length when end of packet detected. 0 When there is no more input.
+ */
+int16_t proc_input(proto_pkt_t* pkt_received) {
+
+    uint32_t bytes = 0;
+
+    while(Serial.available() > 0) {
+
+        int16_t error_code = proto_frame_char(&input_framer, (char)Serial.read());
+        bytes++;
+
+        if(error_code == PROTO_FRAME_LINE) {
+            pktReceivedUs = micros();
+            error_code = proto_parse_pkt_buffer(input_framer.buffer, input_framer.line_len, pkt_received);
+            protoStats.packet();
+            controllerStats->packets++;
+
+            if(error_code > 0) {
+                protoStats.received(bytes);
+                return error_code;
+            }
+        } else if(error_code < 0) {
+            proto_clear_pkt(pkt_received);
+            if(error_code == ERR_PROTO_CP_CMD_OVERFLOW) protoStats.overflow();
+        }
+
+        if(error_code < 0) {
+            protoStats.error(error_code);
+            proc_print_error(pkt_received, &pkt_response, error_code);
+        }
+    }
+
+    protoStats.received(bytes);
+
+    return 0;
+}
+
+/**
+ * @brief proc_run_cmd - Calls a command's handler, counting the time it takes and any error it
+ * responds with
+ */
+void proc_run_cmd(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc) {
+
+    uint32_t start = micros();
+
+    pkt_response.error_code = ERR_PROTO_SUCCESS;
+    cmd->handler(cmd, args, argc, &pkt_response);
+
+    protoStats.handled(cmd - COMMANDS, micros() - start);
+    protoStats.error(pkt_response.error_code);
+    if(pkt_response.error_code < 0) controllerStats->errors++;
+}
+
+/**
+ * @brief proc_pending_cmds - Applies all queued coalesced commands in the order they arrived
+ */
+void proc_pending_cmds() {
+
+    while(cmd_pending_count > 0) {
+
+        uint8_t oldest = COMMAND_COUNT;
+        for(uint8_t i=0; i<COMMAND_COUNT; i++) {
+            if(cmd_pending[i].pending && (oldest == COMMAND_COUNT || cmd_pending[i].seq - cmd_pending[oldest].seq >= 0x80000000))
+                oldest = i;
+        }
+
+        pending_cmd_t* pending = &cmd_pending[oldest];
+        pending->pending = false;
+        cmd_pending_count--;
+        pktReceivedUs = pending->receivedUs;
+        proc_run_cmd(&COMMANDS[oldest], pending->args, pending->argc);
+    }
+}
+
+/**
+ * @brief proc_queue_cmd - Queues a coalesced command to be applied later. A command already
+ * waiting is superseded and acknowledged as coalesced.
+ */
+void proc_queue_cmd(const proto_cmd_t* cmd, const proto_arg_t* args, uint8_t argc) {
+
+    pending_cmd_t* pending = &cmd_pending[cmd - COMMANDS];
+
+    if(pending->pending) {
+        proto_init_response_pkt(&pkt_response, cmd->name);
+        proto_set_response_pkt_error_code(&pkt_response, ERR_PROTO_COALESCED);
+        proto_print_response_pkt(&pkt_response);
+    } else {
+        pending->pending = true;
+        cmd_pending_count++;
+    }
+
+    memcpy(pending->args, args, argc * sizeof(proto_arg_t));
+    pending->argc = argc;
+    pending->receivedUs = pktReceivedUs;
+    pending->seq = cmd_pending_seq++;
+}
+
+/**
+ * @brief proc_cmd - Looks up a received packet's command, parses its params and either queues it
+ * (coalesced commands) or calls its handler
+ */
+void proc_cmd(proto_pkt_t* pkt_received) {
+
+    const proto_cmd_t* cmd = proto_find_cmd(COMMANDS, COMMAND_COUNT, pkt_received);
+
+    if(FEATURE_RECORDER && packetRecorder.recording()
+            && (cmd == NULL || (cmd->handler != proc_set_recording && cmd->handler != proc_get_recording))) {
+        uint16_t end = pkt_received->params.offset > 0 ?
+                    pkt_received->params.offset + pkt_received->params.len :
+                    pkt_received->cmd.offset + pkt_received->cmd.len;
+        packetRecorder.record(pktReceivedUs,
+                              pkt_received->buffer + pkt_received->cmd.offset,
+                              end - pkt_received->cmd.offset);
+    }
+
+    if(cmd == NULL) {
+        protoStats.error(ERR_PROTO_CP_CMD_UNKNOWN);
+        proc_print_error(pkt_received, &pkt_response, ERR_PROTO_CP_CMD_UNKNOWN);
+        return;
+    }
+
+    protoStats.command(cmd - COMMANDS);
+
+    proto_arg_t args[MAX_PROTO_ARGS];
+    int16_t argc = proto_parse_args(cmd, pkt_received, args);
+
+    if(argc < 0) {
+        protoStats.error(argc);
+        proc_print_error(pkt_received, &pkt_response, argc);
+    } else if(cmd->coalesce && argc <= MAX_COALESCED_ARGS) {
+        proc_queue_cmd(cmd, args, argc);
+    } else {
+        proc_pending_cmds();
+        proc_run_cmd(cmd, args, argc);
+    }
+}
+
+
+/* *
+ * VirtualController - One simulated controller, its PTY and the thread that runs the firmware's
+ * loop on it
+ * */
+class VirtualController
+{
+
+private:
+    int m_id;
+    int m_master;
+    int m_slave;
+    char m_port[64];
+
+    uint32_t m_lastFrameMs;
+    uint32_t m_lastForcedRenderMs;
+    uint32_t m_pktStartUs;
+    uint32_t m_lastResponseUs;
+    uint64_t m_showAtResponseUs;
+    bool m_waitingOnHost;
+
+    /**
+     * @brief packetStarting - Times the wait on the host when the first byte of a packet arrives
+     */
+    void packetStarting()
+    {
+        if(Serial.available() == 0 || input_framer.len != 0 || input_framer.skipped != 0) return;
+
+        m_pktStartUs = micros();
+
+        if(m_waitingOnHost) {
+            m_waitingOnHost = false;
+            stats.hostWaitUs += m_pktStartUs - m_lastResponseUs - (stats.showUs - m_showAtResponseUs);
+            stats.hostWaits++;
+        }
+    }
+
+    /**
+     * @brief responded - Sends the responses waiting in Serial, the host is waited on from then
+     */
+    void responded()
+    {
+        Serial.flush();
+
+        m_lastResponseUs = micros();
+        m_showAtResponseUs = stats.showUs;
+        m_waitingOnHost = true;
+    }
+
+    /**
+     * @brief serviced - Sends the responses of a handled packet and times its service
+     */
+    void serviced()
+    {
+        responded();
+
+        uint32_t serviceUs = m_lastResponseUs - m_pktStartUs;
+        stats.serviceUs += serviceUs;
+        stats.serviceMaxUs = max(stats.serviceMaxUs, serviceUs);
+    }
+
+public:
+    controller_stats_t stats;
+
+    VirtualController(int id) :
+        m_id(id),
+        m_master(-1),
+        m_slave(-1),
+        m_lastFrameMs(0),
+        m_lastForcedRenderMs(0),
+        m_pktStartUs(0),
+        m_lastResponseUs(0),
+        m_showAtResponseUs(0),
+        m_waitingOnHost(false)
+    {
+        m_port[0] = 0;
+    }
+
+    ~VirtualController()
+    {
+        if(m_master >= 0) close(m_master);
+        if(m_slave >= 0) close(m_slave);
+    }
+
+    bool open()
+    {
+        return host_open_pty(&m_master, &m_slave, m_port, sizeof(m_port));
+    }
+
+    const char* port() const
+    {
+        return m_port;
+    }
+
+    int id() const
+    {
+        return m_id;
+    }
+
+    /**
+     * @brief run - The firmware's setup() and loop(), runs until the simulation stops
+     */
+    void run()
+    {
+        controllerStats = &stats;
+        Serial.bind(m_master);
+        proto_init_framer(&input_framer, char_in_buffer, MAX_INPUT_BUFFER_LEN);
+        numLeds = options.leds;
+        tempo.subscribe(on_tempo_event);
+
+        while(running) {
+
+            uint32_t now = millis();
+            int32_t untilFrame = (int32_t)(m_lastFrameMs + options.frameMs - now);
+
+            struct pollfd pfd = { m_master, POLLIN, 0 };
+            if(Serial.available() == 0 && untilFrame > 0 && cmd_pending_count == 0 && !render_requested
+                    && !frameReadback.active() && framesToStep == 0)
+                poll(&pfd, 1, min(untilFrame, (int32_t)100));
+
+            packetStarting();
+            for(uint8_t n=0; n<MAX_PACKETS_PER_PASS && proc_input(&pkt_receive) > 0; n++) {
+                proc_cmd(&pkt_receive);
+                serviced();
+                packetStarting();
+            }
+            responded();
+
+            now = millis();
+            bool forceAllowed = now - m_lastForcedRenderMs >= MIN_FORCED_RENDER_INTERVAL_MS;
+
+            if(cmd_pending_count > 0 && forceAllowed) {
+                proc_pending_cmds();
+                responded();
+            }
+
+            bool forceRender = render_requested && forceAllowed;
+
+            tempo.update(effect_clock_ms());
+
+            if(effectClockFrozen) {
+
+                if(framesToStep > 0) {
+                    framesToStep--;
+                    effectClockFrozenMs += options.frameMs;
+                    render_frame(true);
+                } else if(forceRender) {
+                    m_lastForcedRenderMs = now;
+                    render_frame(false);
+                }
+
+            } else if(beatRenderDue || now - m_lastFrameMs >= (uint32_t)options.frameMs) {
+
+                m_lastFrameMs = now;
+                if(forceRender) m_lastForcedRenderMs = now;
+                render_frame(true);
+
+            } else if(forceRender) {
+
+                m_lastForcedRenderMs = now;
+                render_frame(redraw_requested);
+            }
+
+            if(frameReadback.active() && Serial.availableForWrite() > READBACK_CHUNK_CHARS + MAX_PROTO_CMD + 16) {
+                proc_frame_readback_chunk();
+                Serial.flush();
+            }
+        }
+    }
+
+};
+
+
+/* *
+ * Host side stats for one controller
+ * */
+typedef struct host_stats_struct
+{
+    std::vector<uint32_t> latencyUs;        // Round trip latency of each command
+    uint64_t timeouts = 0;                  // Commands without a response
+    uint64_t errors = 0;                    // Responses with an error code
+} host_stats_t;
+
+/**
+ * @brief drive - Built in host, sends a mix of setters and queries to one controller and times the
+ * response to each
+ * @param vc
+ * @param stats
+ */
+void drive(const VirtualController* vc, host_stats_t* stats) {
+
+    static const char* const mix[] = { "CSC:%06X", "CSB:%02X", "CGS", "CSE:%02X", "CGT" };
+
+    int fd = host_open_port(vc->port());
+    if(fd < 0) {
+        fprintf(stderr, "loadsim: can't open %s\n", vc->port());
+        return;
+    }
+
+    uint64_t next = host_clock_us();
+    uint32_t seq = vc->id();
+    char body[64], packet[96], line[MAX_PROTO_PACKET_LEN];
+
+    while(running) {
+
+        if(options.rate > 0) {
+            uint64_t now = host_clock_us();
+            if(next > now) usleep(next - now);
+            next += 1000000 / options.rate;
+        }
+
+        const char* format = mix[seq % (sizeof(mix) / sizeof(mix[0]))];
+        uint32_t value = seq * 2654435761u;
+        snprintf(body, sizeof(body), format, strstr(format, "CSE") ? value % AvailableEffects::MAX_EFFECT : value & (strstr(format, "CSC") ? 0xFFFFFF : 0xFF));
+        seq++;
+
+        size_t len = host_build_packet(body, packet, sizeof(packet));
+        uint64_t sent = host_clock_us();
+
+        if(!host_write_all(fd, packet, len)) break;
+
+        if(host_read_line(fd, line, sizeof(line), 1000) < 0) {
+            if(running) stats->timeouts++;
+            continue;
+        }
+
+        stats->latencyUs.push_back(host_clock_us() - sent);
+
+        // An error code is the first param and always negative
+        if(strchr(line, PROTO_PSC) && strchr(line, PROTO_PSC)[1] == '-') stats->errors++;
+    }
+
+    close(fd);
+}
+
+void stop(int) {
+    running = false;
+}
+
+void usage() {
+    fprintf(stderr, "usage: loadsim [-n instances] [-t seconds] [-l link dir] [-d] [-r rate] [-L leds] [-f frame ms] [-v]\n");
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+
+    int opt;
+    while((opt = getopt(argc, argv, "n:t:l:dr:L:f:v")) != -1) {
+        switch(opt) {
+        case 'n': options.instances = atoi(optarg); break;
+        case 't': options.seconds = atoi(optarg); break;
+        case 'l': options.linkDir = optarg; break;
+        case 'd': options.drive = true; break;
+        case 'r': options.rate = atoi(optarg); break;
+        case 'L': options.leds = atoi(optarg); break;
+        case 'f': options.frameMs = atoi(optarg); break;
+        case 'v': options.verbose = true; break;
+        default: usage();
+        }
+    }
+
+    if(options.instances <= 0 || options.leds <= 0 || options.leds > MAX_LEDS || options.frameMs <= 0) usage();
+    if(options.seconds < 0) options.seconds = options.drive ? 10 : 0;
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    std::vector<VirtualController*> controllers;
+
+    for(int i = 0; i < options.instances; i++) {
+
+        VirtualController* vc = new VirtualController(i);
+
+        if(!vc->open()) {
+            fprintf(stderr, "loadsim: can't open PTY for controller %d: %s\n", i, strerror(errno));
+            return 1;
+        }
+
+        if(options.linkDir) {
+            char link[256];
+            snprintf(link, sizeof(link), "%s/ledsim%d", options.linkDir, i);
+            unlink(link);
+            if(symlink(vc->port(), link) != 0)
+                fprintf(stderr, "loadsim: can't link %s: %s\n", link, strerror(errno));
+        }
+
+        if(options.verbose || !options.drive) printf("controller %d: %s\n", i, vc->port());
+        controllers.push_back(vc);
+    }
+
+    fflush(stdout);
+
+    std::vector<std::thread> threads;
+    std::vector<host_stats_t> hostStats(options.instances);
+
+    for(VirtualController* vc : controllers)
+        threads.emplace_back(&VirtualController::run, vc);
+
+    if(options.drive)
+        for(int i = 0; i < options.instances; i++)
+            threads.emplace_back(drive, controllers[i], &hostStats[i]);
+
+    uint64_t start = host_clock_us();
+
+    while(running && (options.seconds == 0 || host_clock_us() - start < (uint64_t)options.seconds * 1000000))
+        usleep(100000);
+
+    running = false;
+    double elapsed = (host_clock_us() - start) / 1e6;
+
+    for(std::thread& t : threads) t.join();
+
+    // Controller side
+    controller_stats_t total;
+    for(VirtualController* vc : controllers) {
+
+        const controller_stats_t& s = vc->stats;
+        total.packets += s.packets;
+        total.errors += s.errors;
+        total.frames += s.frames;
+        total.presents += s.presents;
+        total.serviceUs += s.serviceUs;
+        total.serviceMaxUs = max(total.serviceMaxUs, s.serviceMaxUs);
+        total.showUs += s.showUs;
+        total.hostWaitUs += s.hostWaitUs;
+        total.hostWaits += s.hostWaits;
+
+        if(options.verbose)
+            printf("controller %3d: %8llu pkts %6llu errs %6llu frames  busy %5.1f%%  host wait %8.0fus\n",
+                   vc->id(),
+                   (unsigned long long)s.packets,
+                   (unsigned long long)s.errors,
+                   (unsigned long long)s.frames,
+                   100.0 * (s.serviceUs + s.showUs) / (elapsed * 1e6),
+                   s.hostWaits ? (double)s.hostWaitUs / s.hostWaits : 0.0);
+    }
+
+    printf("\n%d controllers, %.1fs\n", options.instances, elapsed);
+    printf("controllers: %llu packets (%.0f/s), %llu errors, %llu frames, %llu streamed frames presented\n",
+           (unsigned long long)total.packets, total.packets / elapsed,
+           (unsigned long long)total.errors, (unsigned long long)total.frames,
+           (unsigned long long)total.presents);
+    printf("controllers: mean service %.1fus, max %uus, busy %.1f%% (show %.1f%%), mean host wait %.0fus\n",
+           total.packets ? (double)total.serviceUs / total.packets : 0.0,
+           (unsigned)total.serviceMaxUs,
+           100.0 * (total.serviceUs + total.showUs) / (elapsed * 1e6 * options.instances),
+           100.0 * total.showUs / (elapsed * 1e6 * options.instances),
+           total.hostWaits ? (double)total.hostWaitUs / total.hostWaits : 0.0);
+
+    // Host side
+    if(options.drive) {
+
+        std::vector<uint32_t> all;
+        uint64_t timeouts = 0, errors = 0;
+        uint32_t worstP99 = 0;
+        int worst = 0;
+
+        for(int i = 0; i < options.instances; i++) {
+
+            host_stats_t& s = hostStats[i];
+            all.insert(all.end(), s.latencyUs.begin(), s.latencyUs.end());
+            timeouts += s.timeouts;
+            errors += s.errors;
+
+            size_t count = s.latencyUs.size();
+            uint32_t p50 = host_percentile(s.latencyUs, 50);
+            uint32_t p99 = host_percentile(s.latencyUs, 99);
+            uint32_t pmax = host_percentile(s.latencyUs, 100);
+
+            if(p99 > worstP99) {
+                worstP99 = p99;
+                worst = i;
+            }
+
+            if(options.verbose)
+                printf("host %3d: %8zu cmds  p50 %6uus  p99 %6uus  max %6uus  %llu timeouts\n",
+                       i, count, (unsigned)p50, (unsigned)p99, (unsigned)pmax, (unsigned long long)s.timeouts);
+        }
+
+        printf("host: %zu commands (%.0f/s), %llu timeouts, %llu error responses\n",
+               all.size(), all.size() / elapsed, (unsigned long long)timeouts, (unsigned long long)errors);
+        printf("host: latency p50 %uus, p90 %uus, p99 %uus, max %uus, worst controller %d (p99 %uus)\n",
+               (unsigned)host_percentile(all, 50),
+               (unsigned)host_percentile(all, 90),
+               (unsigned)host_percentile(all, 99),
+               (unsigned)host_percentile(all, 100),
+               worst, (unsigned)worstP99);
+    }
+
+    if(options.linkDir) {
+        for(int i = 0; i < options.instances; i++) {
+            char link[256];
+            snprintf(link, sizeof(link), "%s/ledsim%d", options.linkDir, i);
+            unlink(link);
+        }
+    }
+
+    for(VirtualController* vc : controllers) delete vc;
+
+    return 0;
+}
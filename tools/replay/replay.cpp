@@ -0,0 +1,493 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * replay - Records command streams and replays them against a controller to benchmark protocol
+ * and render changes with a reproducible workload.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -pthread -I tools/host -I include tools/replay/replay.cpp -o replay
+ *
+ * Usage
+ *      replay record -p port -o file [-l link]
+ *          Opens a PTY for the host software to use in place of port and forwards everything
+ *          between the two, recording each packet the host sends. The PTY path is printed, -l
+ *          also links it to link.
+ *
+ *      replay dump -p port -o file
+ *          Reads the controller's own recording (CSR/CGR commands) into file.
+ *
+ *      replay play -p port -i file [-s speed] [-m] [-w window]
+ *          Sends a recording to the controller, at its original timing scaled by speed (default 1)
+ *          or with -m as fast as the controller answers with up to window commands outstanding
+ *          (default 1). Reports command latency, how late packets were sent against the
+ *          recording's timing and the controller's render telemetry (CGT) afterwards.
+ *
+ * The port can be a Teensy, or a loadsim controller PTY when no hardware is at hand.
+ *
+ * Recordings are text, one packet per line as the time in microseconds since recording started
+ * and the packet body between STX and ETX:
+ *
+ *      # ledsc recording
+ *      0 CSE:01
+ *      15320 CSC:FF0000
+ * */
+
+#include <Arduino.h>
+#include "protocol.h"
+#include "hostport.h"
+
+#include <signal.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RECORDING_HEADER            "# ledsc recording"
+#define RESPONSE_TIMEOUT_MS         2000
+
+
+/* *
+ * One recorded packet
+ * */
+typedef struct record_struct
+{
+    uint64_t timeUs;                        // Time since recording started
+    std::string body;                       // Packet body between STX and ETX
+} record_t;
+
+
+void stop(int) {
+    // Only interrupts poll() so a recording is closed cleanly
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: replay record -p port -o file [-l link]\n"
+            "       replay dump -p port -o file\n"
+            "       replay play -p port -i file [-s speed] [-m] [-w window]\n");
+    exit(1);
+}
+
+/**
+ * @brief packet_body - Gets the body of a framed packet
+ * @param packet - Packet without the CR
+ * @param body - Set to the body
+ * @return false when the packet has no STX and ETX
+ */
+bool packet_body(const char* packet, std::string* body) {
+    const char* stx = strchr(packet, PROTO_STX);
+    const char* etx = stx ? strchr(stx, PROTO_ETX) : nullptr;
+
+    if(etx == nullptr) return false;
+
+    body->assign(stx + 1, etx - stx - 1);
+    return true;
+}
+
+/**
+ * @brief response_error - Gets the error code of a response, the first param
+ * @param line
+ * @return
+ */
+int response_error(const char* line) {
+    const char* psc = strchr(line, PROTO_PSC);
+    return psc ? atoi(psc + 1) : ERR_PROTO_CP_MISSING_PARAMS;
+}
+
+/**
+ * @brief command - Sends a command and waits for its response, skipping any other output
+ * @param fd
+ * @param body - Command and params
+ * @param line - Response output
+ * @param lineLen - Size of line
+ * @return false on timeout
+ */
+bool command(int fd, const char* body, char* line, size_t lineLen) {
+    char packet[MAX_PROTO_PACKET_LEN + 8];
+    size_t len = host_build_packet(body, packet, sizeof(packet));
+    size_t cmdLen = strcspn(body, ":");
+
+    if(!host_write_all(fd, packet, len)) return false;
+
+    while(host_read_line(fd, line, lineLen, RESPONSE_TIMEOUT_MS) >= 0)
+        if(line[0] == PROTO_STX && strncmp(line + 1, body, cmdLen) == 0 && line[1 + cmdLen] == PROTO_PSC)
+            return true;
+
+    return false;
+}
+
+/**
+ * @brief do_record - Records the packets host software sends through a PTY proxy
+ * @param port
+ * @param file
+ * @param link
+ * @return
+ */
+int do_record(const char* port, const char* file, const char* link) {
+
+    int dev = host_open_port(port);
+    if(dev < 0) {
+        fprintf(stderr, "replay: can't open %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    int master, slave;
+    char name[64];
+    if(!host_open_pty(&master, &slave, name, sizeof(name))) {
+        fprintf(stderr, "replay: can't open PTY: %s\n", strerror(errno));
+        return 1;
+    }
+
+    FILE* out = fopen(file, "w");
+    if(out == nullptr) {
+        fprintf(stderr, "replay: can't create %s: %s\n", file, strerror(errno));
+        return 1;
+    }
+
+    if(link) {
+        unlink(link);
+        if(symlink(name, link) != 0) fprintf(stderr, "replay: can't link %s: %s\n", link, strerror(errno));
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    fprintf(out, "%s\n", RECORDING_HEADER);
+    printf("recording packets sent to %s, connect host software to %s, Ctrl-C to stop\n", port, name);
+    fflush(stdout);
+
+    char line[MAX_PROTO_PACKET_LEN];
+    size_t lineLen = 0;
+    uint64_t startUs = 0;
+    unsigned long count = 0;
+    struct pollfd pfds[2] = { { master, POLLIN, 0 }, { dev, POLLIN, 0 } };
+
+    while(poll(pfds, 2, -1) >= 0) {
+
+        char buff[256];
+        ssize_t n;
+
+        if(pfds[0].revents & POLLIN) {
+
+            uint64_t nowUs = host_clock_us();
+            n = read(master, buff, sizeof(buff));
+            if(n > 0 && !host_write_all(dev, buff, n)) break;
+
+            for(ssize_t i = 0; i < n; i++) {
+
+                if(buff[i] != PROTO_CR) {
+                    if(lineLen + 1 < sizeof(line) && buff[i] != PROTO_NL) line[lineLen++] = buff[i];
+                    continue;
+                }
+
+                line[lineLen] = 0;
+                lineLen = 0;
+
+                std::string body;
+                if(!packet_body(line, &body)) continue;
+
+                if(count++ == 0) startUs = nowUs;
+                fprintf(out, "%llu %s\n", (unsigned long long)(nowUs - startUs), body.c_str());
+                fflush(out);
+            }
+        }
+
+        if(pfds[1].revents & POLLIN) {
+            n = read(dev, buff, sizeof(buff));
+            if(n <= 0) break;
+            host_write_all(master, buff, n);
+        }
+
+        if(pfds[1].revents & (POLLHUP | POLLERR)) break;
+    }
+
+    fclose(out);
+    if(link) unlink(link);
+    printf("recorded %lu packets\n", count);
+    return 0;
+}
+
+/**
+ * @brief do_dump - Reads the controller's recording
+ * @param port
+ * @param file
+ * @return
+ */
+int do_dump(const char* port, const char* file) {
+
+    int dev = host_open_port(port);
+    if(dev < 0) {
+        fprintf(stderr, "replay: can't open %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    char line[MAX_PROTO_PACKET_LEN + 64];
+    if(!command(dev, "CGR", line, sizeof(line)) || response_error(line) != ERR_PROTO_SUCCESS) {
+        fprintf(stderr, "replay: controller has no recorder\n");
+        return 1;
+    }
+
+    // [CGR:0:COUNT|DROPPED|RECORDING]
+    unsigned count = 0, dropped = 0, recording = 0;
+    sscanf(strchr(line + 1, PROTO_PSC) + 3, "%X|%X|%X", &count, &dropped, &recording);
+
+    if(recording) fprintf(stderr, "replay: controller is still recording, dumping what it has so far\n");
+    if(dropped) fprintf(stderr, "replay: controller dropped %u packets once its recorder was full\n", dropped);
+
+    FILE* out = fopen(file, "w");
+    if(out == nullptr) {
+        fprintf(stderr, "replay: can't create %s: %s\n", file, strerror(errno));
+        return 1;
+    }
+
+    fprintf(out, "%s\n", RECORDING_HEADER);
+
+    for(unsigned i = 0; i < count; i++) {
+
+        char body[16];
+        snprintf(body, sizeof(body), "CGR:%X", i);
+
+        if(!command(dev, body, line, sizeof(line)) || response_error(line) != ERR_PROTO_SUCCESS) {
+            fprintf(stderr, "replay: failed reading record %u\n", i);
+            fclose(out);
+            return 1;
+        }
+
+        // [CGR:0:TIME:BODY]
+        std::string packet;
+        packet_body(line, &packet);
+        size_t timeAt = packet.find(PROTO_PSC, 4) + 1;
+        size_t bodyAt = packet.find(PROTO_PSC, timeAt) + 1;
+
+        fprintf(out, "%lu %s\n", strtoul(packet.c_str() + timeAt, nullptr, 16), packet.c_str() + bodyAt);
+    }
+
+    fclose(out);
+    printf("dumped %u packets\n", count);
+    return 0;
+}
+
+/**
+ * @brief load - Loads a recording
+ * @param file
+ * @param records
+ * @return false on error
+ */
+bool load(const char* file, std::vector<record_t>* records) {
+
+    FILE* in = fopen(file, "r");
+    if(in == nullptr) return false;
+
+    char line[MAX_PROTO_PACKET_LEN + 32];
+    while(fgets(line, sizeof(line), in)) {
+
+        if(line[0] == '#' || line[0] == '\n') continue;
+
+        char* body;
+        record_t record;
+        record.timeUs = strtoull(line, &body, 10);
+
+        if(*body != ' ') continue;
+
+        record.body = body + 1;
+        while(!record.body.empty() && (record.body.back() == '\n' || record.body.back() == '\r'))
+            record.body.pop_back();
+
+        records->push_back(record);
+    }
+
+    fclose(in);
+    return true;
+}
+
+/**
+ * @brief do_play - Replays a recording and reports latency and frame stats
+ * @param port
+ * @param file
+ * @param speed - Timing scale, 2 plays twice as fast
+ * @param max - Ignore the recorded timing and send as fast as responses allow
+ * @param window - Max commands outstanding with max
+ * @return
+ */
+int do_play(const char* port, const char* file, double speed, bool max, int window) {
+
+    std::vector<record_t> records;
+    if(!load(file, &records) || records.empty()) {
+        fprintf(stderr, "replay: can't load %s\n", file);
+        return 1;
+    }
+
+    int dev = host_open_port(port);
+    if(dev < 0) {
+        fprintf(stderr, "replay: can't open %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    char line[MAX_PROTO_PACKET_LEN + 64];
+
+    // Reset the controller's max latency so the telemetry afterwards only covers the replay
+    command(dev, "CGT", line, sizeof(line));
+
+    std::mutex lock;
+    std::deque<uint64_t> sentUs;                // Send time of each command waiting for a response
+    std::vector<uint32_t> latencyUs;
+    std::vector<uint32_t> lateUs;
+    unsigned long errors = 0, coalesced = 0, timeouts = 0;
+    size_t responses = 0;
+    bool done = false;
+
+    // Responses come back in command order, match them to send times as they arrive
+    std::thread reader([&]() {
+        while(true) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if(done && sentUs.empty()) break;
+            }
+
+            if(host_read_line(dev, line, sizeof(line), RESPONSE_TIMEOUT_MS) < 0) {
+                std::lock_guard<std::mutex> guard(lock);
+                if(done) {
+                    timeouts += sentUs.size();
+                    sentUs.clear();
+                }
+                continue;
+            }
+
+            if(line[0] != PROTO_STX) continue;
+
+            uint64_t nowUs = host_clock_us();
+            int error = response_error(line);
+
+            std::lock_guard<std::mutex> guard(lock);
+            if(sentUs.empty()) continue;
+
+            latencyUs.push_back(nowUs - sentUs.front());
+            sentUs.pop_front();
+            responses++;
+
+            if(error == ERR_PROTO_COALESCED) coalesced++;
+            else if(error != ERR_PROTO_SUCCESS) errors++;
+        }
+    });
+
+    uint64_t startUs = host_clock_us();
+
+    for(const record_t& record : records) {
+
+        if(max) {
+            while(true) {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if((int)sentUs.size() < window) break;
+                }
+                usleep(20);
+            }
+        } else {
+            uint64_t dueUs = startUs + (uint64_t)(record.timeUs / speed);
+            uint64_t nowUs = host_clock_us();
+            if(dueUs > nowUs) usleep(dueUs - nowUs);
+            lateUs.push_back(host_clock_us() - dueUs);
+        }
+
+        char packet[MAX_PROTO_PACKET_LEN + 8];
+        size_t len = host_build_packet(record.body.c_str(), packet, sizeof(packet));
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            sentUs.push_back(host_clock_us());
+        }
+
+        if(!host_write_all(dev, packet, len)) {
+            fprintf(stderr, "replay: write to %s failed\n", port);
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+    }
+
+    reader.join();
+    double elapsed = (host_clock_us() - startUs) / 1e6;
+
+    printf("%zu packets in %.2fs (%.0f/s), %zu responses, %lu errors, %lu coalesced, %lu timeouts\n",
+           records.size(), elapsed, records.size() / elapsed, responses, errors, coalesced, timeouts);
+    printf("latency p50 %uus, p90 %uus, p99 %uus, max %uus\n",
+           (unsigned)host_percentile(latencyUs, 50),
+           (unsigned)host_percentile(latencyUs, 90),
+           (unsigned)host_percentile(latencyUs, 99),
+           (unsigned)host_percentile(latencyUs, 100));
+
+    if(!max)
+        printf("send lateness p99 %uus, max %uus\n",
+               (unsigned)host_percentile(lateUs, 99),
+               (unsigned)host_percentile(lateUs, 100));
+
+    // [CGT:0:LAST|MAX|FPS|RENDER|SHOW|INTERVAL]
+    if(command(dev, "CGT", line, sizeof(line)) && response_error(line) == ERR_PROTO_SUCCESS) {
+        unsigned long last = 0, maxLatency = 0, render = 0, show = 0;
+        unsigned fps = 0, interval = 0;
+        sscanf(strchr(line + 1, PROTO_PSC) + 3, "%lX|%lX|%X|%lX|%lX|%X", &last, &maxLatency, &fps, &render, &show, &interval);
+        printf("controller: command to show latency last %luus, max %luus, %u fps, render %luus, show %luus, frame interval %ums\n",
+               last, maxLatency, fps, render, show, interval);
+    }
+
+    close(dev);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+
+    if(argc < 2) usage();
+
+    const char* mode = argv[1];
+    const char* port = nullptr;
+    const char* in = nullptr;
+    const char* out = nullptr;
+    const char* link = nullptr;
+    double speed = 1.0;
+    bool max = false;
+    int window = 1;
+
+    int opt;
+    optind = 2;
+    while((opt = getopt(argc, argv, "p:i:o:l:s:mw:")) != -1) {
+        switch(opt) {
+        case 'p': port = optarg; break;
+        case 'i': in = optarg; break;
+        case 'o': out = optarg; break;
+        case 'l': link = optarg; break;
+        case 's': speed = atof(optarg); break;
+        case 'm': max = true; break;
+        case 'w': window = atoi(optarg); break;
+        default: usage();
+        }
+    }
+
+    if(port == nullptr || speed <= 0 || window <= 0) usage();
+
+    if(strcmp(mode, "record") == 0 && out) return do_record(port, out, link);
+    if(strcmp(mode, "dump") == 0 && out) return do_dump(port, out);
+    if(strcmp(mode, "play") == 0 && in) return do_play(port, in, speed, max, window);
+
+    usage();
+}
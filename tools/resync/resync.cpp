@@ -0,0 +1,335 @@
+/* *
+ * Teensy LED Strip Control Interface
+ *
+ * Copyright (C) 2021 Thomas G. Kenny Jr
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* *
+ * resync - Measures how many commands survive a noisy serial link with the firmware's input
+ * framing, against the framing it replaced.
+ *
+ * Builds a stream of command packets, setters and Write Frame packets of every length, and
+ * injects glitches into it: bursts of random bytes between packets, lost CRs, corrupted bytes,
+ * packets cut short and long runs of noise that overflow the input buffer. The stream is fed
+ * through the previous proc_input() framing, which only split lines at CR and emptied the whole
+ * buffer on overflow, and through proto_frame_char(), in the serial read sizes of a USB link.
+ *
+ * For each it reports the share of commands received intact, overall and of the command right
+ * after each kind of glitch, commands accepted that don't match one sent, error responses and
+ * the share of bytes that didn't deliver an intact command. Commands a glitch landed in can't be
+ * recovered, the rates that matter are those of the commands around them. The firmware is built
+ * without CRC16 checks, so corrupted packets that still parse are accepted as foreign commands.
+ *
+ * Build
+ *      g++ -std=c++17 -O2 -I tools/host -I include tools/resync/resync.cpp -o resync
+ *
+ * Usage
+ *      resync [-n commands] [-p glitch percent] [-c read size] [-s seed]
+ *
+ *      -n  Commands to send (default 100000)
+ *      -p  Chance of a glitch after each command in percent (default 5)
+ *      -c  Bytes handed to the framing per serial read (default 64, a USB packet)
+ *      -s  Random seed (default 1)
+ * */
+
+#include <Arduino.h>
+#include "protocol.h"
+#include "hostport.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define MAX_INPUT_BUFFER_LEN        MAX_PROTO_PACKET_LEN    // Same as the firmware
+#define NOISE_RUN_LEN               (MAX_INPUT_BUFFER_LEN + 100)
+
+
+/* *
+ * Glitches injected into the stream
+ * */
+enum Glitch
+{
+    GLITCH_NONE,
+    GLITCH_BURST,                   // 1 to 16 random bytes between two packets
+    GLITCH_LOST_CR,                 // A packet's CR is lost
+    GLITCH_CORRUPT,                 // A byte of a packet is replaced
+    GLITCH_CUT,                     // A packet is cut short, the rest of it is lost
+    GLITCH_RUN,                     // A run of noise longer than the input buffer
+    GLITCH_KINDS
+};
+
+static const char* const GLITCH_NAMES[GLITCH_KINDS] = {
+    "none", "burst", "lost CR", "corrupt", "cut", "noise run"
+};
+
+
+/* *
+ * Framing results
+ * */
+typedef struct result_struct
+{
+    std::vector<bool> received;     // Each command received intact
+    uint64_t foreign = 0;           // Commands accepted that don't match one sent
+    uint64_t errors = 0;            // Error responses the controller would send
+    uint64_t receivedBytes = 0;     // Bytes of the packets of the commands received intact
+} result_t;
+
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng() {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+
+/* *
+ * Command stream
+ * */
+typedef struct stream_struct
+{
+    std::string bytes;                                  // Everything sent
+    std::vector<std::string> bodies;                    // Body of each command
+    std::vector<size_t> sizes;                          // Packet size of each command
+    std::vector<Glitch> hit;                            // Glitch that landed in each command
+    std::vector<Glitch> after;                          // Glitch just before each command
+    std::unordered_map<std::string, size_t> index;      // Command of each body
+} stream_t;
+
+/**
+ * @brief build_stream - Builds the packets and injects glitches. Every body is unique so each
+ * accepted packet can be traced to the command it came from.
+ */
+static void build_stream(stream_t* stream, int commands, int percent) {
+
+    char body[MAX_PROTO_PACKET_LEN], packet[MAX_PROTO_PACKET_LEN + 8];
+    Glitch pending = GLITCH_NONE;
+
+    for(int seq = 0; seq < commands; seq++) {
+
+        switch(seq % 3) {
+        case 0:
+            snprintf(body, sizeof(body), "CSC:%06X", seq & 0xFFFFFF);
+            break;
+        case 1:
+            snprintf(body, sizeof(body), "CSTM:%08X", seq);
+            break;
+        default:
+            // Stream frames of 0 to 70 pixels, the last param makes the body unique
+            int pixels = rng() % 71;
+            int n = snprintf(body, sizeof(body), "CWF:0000:02:");
+            for(int i = 0; i < pixels; i++) n += snprintf(body + n, sizeof(body) - n, "%06X", rng() & 0xFFFFFF);
+            snprintf(body + n, sizeof(body) - n, ":%08X", seq);
+            break;
+        }
+
+        std::string bytes(packet, host_build_packet(body, packet, sizeof(packet)));
+        Glitch glitch = (int)(rng() % 100) < percent ? (Glitch)(1 + rng() % (GLITCH_KINDS - 1)) : GLITCH_NONE;
+
+        stream->bodies.push_back(body);
+        stream->sizes.push_back(bytes.size());
+        stream->index[body] = seq;
+        stream->after.push_back(pending);
+        stream->hit.push_back(GLITCH_NONE);
+
+        switch(glitch) {
+        case GLITCH_LOST_CR:
+            bytes.pop_back();
+            stream->hit[seq] = glitch;
+            break;
+        case GLITCH_CORRUPT:
+            bytes[rng() % (bytes.size() - 1)] = (char)(rng() & 0xFF);
+            stream->hit[seq] = glitch;
+            break;
+        case GLITCH_CUT:
+            bytes.resize(1 + rng() % (bytes.size() - 1));
+            stream->hit[seq] = glitch;
+            break;
+        default:
+            break;
+        }
+
+        stream->bytes += bytes;
+
+        if(glitch == GLITCH_BURST || glitch == GLITCH_RUN) {
+            int len = glitch == GLITCH_BURST ? 1 + rng() % 16 : NOISE_RUN_LEN;
+            for(int i = 0; i < len; i++) stream->bytes += (char)(rng() & 0xFF);
+        }
+
+        pending = glitch;
+    }
+}
+
+/**
+ * @brief accept - Records a line that parsed
+ */
+static void accept(const stream_t& stream, const proto_pkt_t& pkt, result_t* result) {
+
+    std::string body(pkt.buffer + pkt.cmd.offset, pkt.cmd.len);
+    if(pkt.param_count > 0) body += PROTO_PSC + std::string(pkt.buffer + pkt.params.offset, pkt.params.len);
+
+    auto it = stream.index.find(body);
+    if(it == stream.index.end()) {
+        result->foreign++;
+    } else if(!result->received[it->second]) {
+        result->received[it->second] = true;
+        result->receivedBytes += stream.sizes[it->second];
+    }
+}
+
+/**
+ * @brief run_legacy - The framing proc_input() used before proto_frame_char(). Lines are split at
+ * CR only and the buffer is emptied after a read that fills it.
+ */
+static void run_legacy(const stream_t& stream, size_t readSize, result_t* result) {
+
+    static char buffer[MAX_INPUT_BUFFER_LEN];
+    uint16_t len = 0;
+    proto_pkt_t pkt;
+
+    for(size_t pos = 0; pos < stream.bytes.size(); pos += readSize) {
+
+        size_t end = min(pos + readSize, stream.bytes.size());
+
+        for(size_t i = pos; i < end; i++) {
+
+            char ich = stream.bytes[i];
+
+            if(len < MAX_INPUT_BUFFER_LEN && ich != PROTO_CR && ich != PROTO_NL)
+                buffer[len++] = ich;
+
+            if(ich == PROTO_CR) {
+                int16_t error_code = proto_parse_pkt_buffer(buffer, len, &pkt);
+
+                if(error_code > 0) accept(stream, pkt, result);
+                else if(error_code < 0) result->errors++;
+
+                len = 0;
+            }
+        }
+
+        if(len >= MAX_INPUT_BUFFER_LEN) {
+            result->errors++;
+            len = 0;
+        }
+    }
+}
+
+/**
+ * @brief run_framer - The firmware's framing with proto_frame_char()
+ */
+static void run_framer(const stream_t& stream, size_t readSize, result_t* result) {
+
+    static char buffer[MAX_INPUT_BUFFER_LEN];
+    proto_framer_t framer;
+    proto_pkt_t pkt;
+
+    proto_init_framer(&framer, buffer, MAX_INPUT_BUFFER_LEN);
+
+    for(size_t pos = 0; pos < stream.bytes.size(); pos += readSize) {
+
+        size_t end = min(pos + readSize, stream.bytes.size());
+
+        for(size_t i = pos; i < end; i++) {
+
+            int16_t error_code = proto_frame_char(&framer, stream.bytes[i]);
+
+            if(error_code == PROTO_FRAME_LINE) {
+                error_code = proto_parse_pkt_buffer(framer.buffer, framer.line_len, &pkt);
+                if(error_code > 0) accept(stream, pkt, result);
+            }
+
+            if(error_code < 0) result->errors++;
+        }
+    }
+}
+
+/**
+ * @brief report - Prints the recovered rates of one framing
+ */
+static void report(const char* name, const stream_t& stream, const result_t& result) {
+
+    uint64_t clean = 0, cleanReceived = 0;
+    uint64_t after[GLITCH_KINDS] = {}, afterReceived[GLITCH_KINDS] = {};
+
+    for(size_t i = 0; i < stream.bodies.size(); i++) {
+
+        if(stream.hit[i] != GLITCH_NONE) continue;
+
+        clean++;
+        cleanReceived += result.received[i];
+        after[stream.after[i]]++;
+        afterReceived[stream.after[i]] += result.received[i];
+    }
+
+    printf("%-8s %9.3f%%", name, clean ? 100.0 * cleanReceived / clean : 0.0);
+
+    for(int g = GLITCH_BURST; g < GLITCH_KINDS; g++)
+        printf(" %9.1f%%", after[g] ? 100.0 * afterReceived[g] / after[g] : 0.0);
+
+    printf(" %8llu %8llu %9.2f%%\n",
+           (unsigned long long)result.foreign,
+           (unsigned long long)result.errors,
+           100.0 * (stream.bytes.size() - result.receivedBytes) / stream.bytes.size());
+}
+
+void usage() {
+    fprintf(stderr, "usage: resync [-n commands] [-p glitch percent] [-c read size] [-s seed]\n");
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+
+    int commands = 100000, percent = 5, readSize = 64;
+
+    int opt;
+    while((opt = getopt(argc, argv, "n:p:c:s:")) != -1) {
+        switch(opt) {
+        case 'n': commands = atoi(optarg); break;
+        case 'p': percent = atoi(optarg); break;
+        case 'c': readSize = atoi(optarg); break;
+        case 's': rng_state = strtoul(optarg, NULL, 0); break;
+        default: usage();
+        }
+    }
+
+    if(commands <= 0 || percent < 0 || percent > 100 || readSize <= 0) usage();
+
+    stream_t stream;
+    build_stream(&stream, commands, percent);
+
+    uint64_t hit = 0;
+    for(Glitch g : stream.hit) hit += g != GLITCH_NONE;
+
+    printf("%d commands, %zu bytes, %d%% glitches, %llu commands hit by one, %d byte reads\n\n",
+           commands, stream.bytes.size(), percent, (unsigned long long)hit, readSize);
+
+    printf("%-8s %10s", "", "clean");
+    for(int g = GLITCH_BURST; g < GLITCH_KINDS; g++) printf(" %10s", GLITCH_NAMES[g]);
+    printf(" %8s %8s %10s\n", "foreign", "errors", "wasted");
+
+    result_t legacy, framer;
+    legacy.received.assign(commands, false);
+    framer.received.assign(commands, false);
+
+    run_legacy(stream, readSize, &legacy);
+    run_framer(stream, readSize, &framer);
+
+    report("legacy", stream, legacy);
+    report("framer", stream, framer);
+
+    return 0;
+}